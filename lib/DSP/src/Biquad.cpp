@@ -171,6 +171,26 @@ void Biquad::initLinkwitzTransform(const uint32_t sampleRate, const double F0, c
     reset();
 }
 
+const double Biquad::getB0() const {
+    return _b0;
+}
+
+const double Biquad::getB1() const {
+    return _b1;
+}
+
+const double Biquad::getB2() const {
+    return _b2;
+}
+
+const double Biquad::getA1() const {
+    return _a1;
+}
+
+const double Biquad::getA2() const {
+    return _a2;
+}
+
 double Biquad::getOmega(const uint32_t sampleRate, const double frequency) const {
     return 2 * M_PI * frequency / sampleRate;
 }
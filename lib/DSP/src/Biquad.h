@@ -24,6 +24,12 @@ public:
     void initPEQ(const uint32_t sampleRate, const double frequency, const double gain, const double q);
     void initLinkwitzTransform(const uint32_t sampleRate, const double F0, const double Q0, const double Fp, const double Qp);
 
+    const double getB0() const;
+    const double getB1() const;
+    const double getB2() const;
+    const double getA1() const;
+    const double getA2() const;
+
     const vector<vector<double>> getFrequencyResponse(const uint32_t sampleRate, const uint32_t nPoints, const double fMin, const double fMax) const;
     void printCoefficients(const bool miniDSPFormat = false) const;
 
@@ -35,10 +41,35 @@ public:
         return out;
     }
 
+    // Transposed direct form II. State is kept in locals for the duration of the block.
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) {
+        const double b0 = _b0, b1 = _b1, b2 = _b2, a1 = _a1, a2 = _a2;
+        double z1 = _z1, z2 = _z2;
+        for (size_t i = 0; i < numSamples; ++i) {
+            const double data = pIn[i];
+            const double out = data * b0 + z1;
+            z1 = data * b1 - out * a1 + z2;
+            z2 = data * b2 - out * a2;
+            pOut[i] = out;
+        }
+        _z1 = z1;
+        _z2 = z2;
+    }
+
     inline void reset() {
         _z1 = _z2 = 0;
     }
 
+    inline void getState(double& z1, double& z2) const {
+        z1 = _z1;
+        z2 = _z2;
+    }
+
+    inline void setState(const double z1, const double z2) {
+        _z1 = z1;
+        _z2 = z2;
+    }
+
 private:
     double _b0, _b1, _b2, _a0, _a1, _a2, _z1, _z2;
 
@@ -0,0 +1,105 @@
+#include "BiquadBank.h"
+#include "FilterBiquad.h"
+#include "Biquad.h"
+#include "FilterArena.h"
+#include <cstring> // memset
+
+BiquadBank::BiquadBank(const vector<const FilterBiquad*>& filters) {
+    _numLanes = filters.size();
+    _numSections = _numLanes ? filters[0]->size() : 0;
+    _numGroups = (_numLanes + SIMD_WIDTH - 1) / SIMD_WIDTH;
+    _pSections = Simd::allocate<Section>(_numGroups * _numSections);
+    for (size_t group = 0; group < _numGroups; ++group) {
+        for (size_t s = 0; s < _numSections; ++s) {
+            Section& section = _pSections[group * _numSections + s];
+            for (size_t lane = 0; lane < SIMD_WIDTH; ++lane) {
+                const size_t filterIndex = group * SIMD_WIDTH + lane;
+                // Unused lanes in the last group are pass through.
+                if (filterIndex >= _numLanes) {
+                    section.b0[lane] = 1;
+                    section.b1[lane] = section.b2[lane] = section.a1[lane] = section.a2[lane] = 0;
+                    continue;
+                }
+                const Biquad& biquad = filters[filterIndex]->getBiquads()[s];
+                section.b0[lane] = biquad.getB0();
+                section.b1[lane] = biquad.getB1();
+                section.b2[lane] = biquad.getB2();
+                section.a1[lane] = biquad.getA1();
+                section.a2[lane] = biquad.getA2();
+            }
+        }
+    }
+    reset();
+}
+
+const size_t BiquadBank::getNumLanes() const {
+    return _numLanes;
+}
+
+const size_t BiquadBank::getNumSections() const {
+    return _numSections;
+}
+
+void BiquadBank::process(double* const* const ppData, const size_t numSamples) {
+    for (size_t group = 0; group < _numGroups; ++group) {
+        double* const* const ppLanes = ppData + group * SIMD_WIDTH;
+        const size_t numLanes = _numLanes - group * SIMD_WIDTH < SIMD_WIDTH ? _numLanes - group * SIMD_WIDTH : SIMD_WIDTH;
+        for (size_t offset = 0; offset < numSamples; offset += BIQUAD_BANK_CHUNK_SIZE) {
+            const size_t count = numSamples - offset < BIQUAD_BANK_CHUNK_SIZE ? numSamples - offset : BIQUAD_BANK_CHUNK_SIZE;
+            // Interleave lanes
+            if (numLanes < SIMD_WIDTH) {
+                memset(_buffer, 0, sizeof(_buffer));
+            }
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                const double* const pLane = ppLanes[lane] + offset;
+                for (size_t i = 0; i < count; ++i) {
+                    _buffer[i * SIMD_WIDTH + lane] = pLane[i];
+                }
+            }
+            processGroup(&_pSections[group * _numSections], count);
+            // Deinterleave lanes
+            for (size_t lane = 0; lane < numLanes; ++lane) {
+                double* const pLane = ppLanes[lane] + offset;
+                for (size_t i = 0; i < count; ++i) {
+                    pLane[i] = _buffer[i * SIMD_WIDTH + lane];
+                }
+            }
+        }
+    }
+}
+
+void BiquadBank::processGroup(Section* const pSections, const size_t numSamples) {
+    // Run one section at a time over the whole chunk so coefficients and state stay in registers.
+    for (size_t s = 0; s < _numSections; ++s) {
+        Section& section = pSections[s];
+        const Simd::Vec b0 = Simd::load(section.b0);
+        const Simd::Vec b1 = Simd::load(section.b1);
+        const Simd::Vec b2 = Simd::load(section.b2);
+        const Simd::Vec a1 = Simd::load(section.a1);
+        const Simd::Vec a2 = Simd::load(section.a2);
+        Simd::Vec z1 = Simd::load(section.z1);
+        Simd::Vec z2 = Simd::load(section.z2);
+        double* pData = _buffer;
+        // Transposed direct form II
+        for (size_t i = 0; i < numSamples; ++i, pData += SIMD_WIDTH) {
+            const Simd::Vec data = Simd::load(pData);
+            const Simd::Vec out = Simd::mulAdd(data, b0, z1);
+            z1 = Simd::mulAdd(data, b1, Simd::sub(z2, Simd::mul(out, a1)));
+            z2 = Simd::sub(Simd::mul(data, b2), Simd::mul(out, a2));
+            Simd::store(pData, out);
+        }
+        Simd::store(section.z1, z1);
+        Simd::store(section.z2, z2);
+    }
+}
+
+void BiquadBank::reset() {
+    for (size_t i = 0; i < _numGroups * _numSections; ++i) {
+        memset(_pSections[i].z1, 0, sizeof(_pSections[i].z1));
+        memset(_pSections[i].z2, 0, sizeof(_pSections[i].z2));
+    }
+}
+
+void BiquadBank::relocate(FilterArena& arena) {
+    arena.relocate(_pSections, _numGroups * _numSections);
+}
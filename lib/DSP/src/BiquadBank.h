@@ -0,0 +1,46 @@
+/*
+    Runs the biquad cascades of multiple channels in parallel SIMD lanes.
+    All cascades must have the same number of sections. Each lane keeps its own coefficients and state.
+*/
+
+#pragma once
+#include <vector>
+#include "Simd.h"
+
+using std::vector;
+
+class FilterArena;
+
+#define BIQUAD_BANK_CHUNK_SIZE 128
+
+class FilterBiquad;
+
+class BiquadBank {
+public:
+
+    BiquadBank(const vector<const FilterBiquad*>& filters);
+
+    const size_t getNumLanes() const;
+    const size_t getNumSections() const;
+
+    // Process one block per lane in place. ppData must contain one buffer per lane.
+    void process(double* const* const ppData, const size_t numSamples);
+    void reset();
+    void relocate(FilterArena& arena);
+
+private:
+    // Coefficients and state for one section in one group of SIMD_WIDTH lanes.
+    struct Section {
+        double b0[SIMD_WIDTH], b1[SIMD_WIDTH], b2[SIMD_WIDTH], a1[SIMD_WIDTH], a2[SIMD_WIDTH];
+        double z1[SIMD_WIDTH], z2[SIMD_WIDTH];
+    };
+
+    // Group major. Sections for group 0 first, then group 1 and so on.
+    Simd::AlignedBuffer<Section> _pSections;
+    // Lanes of one group interleaved sample by sample.
+    double _buffer[BIQUAD_BANK_CHUNK_SIZE * SIMD_WIDTH];
+    size_t _numLanes, _numSections, _numGroups;
+
+    void processGroup(Section* const pSections, const size_t numSamples);
+
+};
@@ -0,0 +1,264 @@
+#include "BiquadParallel.h"
+#include "FilterArena.h"
+#include <complex>
+#include <cmath>
+#include <cstring>
+
+using std::complex;
+using std::make_unique;
+
+// Impulse response length and tolerance used to verify the parallel form against the cascade.
+#define VERIFY_LENGTH 8192
+#define VERIFY_TOLERANCE 1e-9
+
+namespace {
+
+    // Poles of 1 + a1 * z^-1 + a2 * z^-2 that are not zero.
+    vector<complex<double>> getPoles(const Biquad& biquad) {
+        const double a1 = biquad.getA1();
+        const double a2 = biquad.getA2();
+        if (a2 == 0) {
+            if (a1 == 0) {
+                return {};
+            }
+            return { complex<double>(-a1, 0) };
+        }
+        const complex<double> root = std::sqrt(complex<double>(a1 * a1 - 4 * a2, 0));
+        return { (-a1 + root) / 2.0, (-a1 - root) / 2.0 };
+    }
+
+    // Numerator b0 + b1 * w + b2 * w^2 evaluated at w.
+    complex<double> evalNumerator(const Biquad& biquad, const complex<double>& w) {
+        return biquad.getB0() + w * (biquad.getB1() + w * biquad.getB2());
+    }
+
+    // Index of highest non zero coefficient in a second order polynomial c0 + c1 * w + c2 * w^2. c0 doesn't matter.
+    size_t getDegree(const double c1, const double c2) {
+        return c2 != 0 ? 2 : (c1 != 0 ? 1 : 0);
+    }
+
+    double getLeading(const double c0, const double c1, const double c2) {
+        return c2 != 0 ? c2 : (c1 != 0 ? c1 : c0);
+    }
+
+    bool hasSamePoles(const Biquad& a, const Biquad& b) {
+        const double scale = 1 + std::abs(a.getA1()) + std::abs(a.getA2());
+        return std::abs(a.getA1() - b.getA1()) < 1e-12 * scale && std::abs(a.getA2() - b.getA2()) < 1e-12 * scale;
+    }
+
+}
+
+BiquadParallel::BiquadParallel() {
+    _direct = 0;
+    _numParallel = _numGroups = 0;
+}
+
+unique_ptr<BiquadParallel> BiquadParallel::create(const vector<Biquad>& cascade) {
+    // Partial fractions require distinct poles. Sections with a double pole or poles that repeat
+    // an earlier section are kept in the serial cascade.
+    vector<Biquad> parallel, serial;
+    for (const Biquad& biquad : cascade) {
+        const double a1 = biquad.getA1();
+        const double a2 = biquad.getA2();
+        const bool hasDoublePole = a2 != 0 && std::abs(a1 * a1 - 4 * a2) < 1e-14;
+        bool isRepeated = hasDoublePole;
+        for (const Biquad& other : parallel) {
+            if (hasSamePoles(biquad, other)) {
+                isRepeated = true;
+                break;
+            }
+        }
+        if (isRepeated) {
+            serial.push_back(biquad);
+        }
+        else {
+            parallel.push_back(biquad);
+        }
+    }
+
+    // Nothing to gain if the dependency chain isn't shortened.
+    if (parallel.size() < 2) {
+        return nullptr;
+    }
+
+    // Direct term is the limit of numerator / denominator as z^-1 goes to infinity.
+    size_t numeratorDegree = 0, denominatorDegree = 0;
+    double numeratorLeading = 1, denominatorLeading = 1;
+    vector<complex<double>> poles;
+    vector<size_t> poleSections;
+    for (size_t i = 0; i < parallel.size(); ++i) {
+        const Biquad& biquad = parallel[i];
+        numeratorDegree += getDegree(biquad.getB1(), biquad.getB2());
+        denominatorDegree += getDegree(biquad.getA1(), biquad.getA2());
+        numeratorLeading *= getLeading(biquad.getB0(), biquad.getB1(), biquad.getB2());
+        denominatorLeading *= getLeading(1, biquad.getA1(), biquad.getA2());
+        for (const complex<double>& pole : getPoles(biquad)) {
+            // Unstable filters are left alone.
+            if (std::abs(pole) >= 1) {
+                return nullptr;
+            }
+            poles.push_back(pole);
+            poleSections.push_back(i);
+        }
+    }
+    if (numeratorDegree > denominatorDegree) {
+        return nullptr;
+    }
+
+    unique_ptr<BiquadParallel> pResult(new BiquadParallel());
+    pResult->_serial = serial;
+    pResult->_direct = numeratorDegree == denominatorDegree ? numeratorLeading / denominatorLeading : 0;
+
+    // Residue of each pole p: numerator(1/p) / product of (1 - q/p) for all other poles q.
+    vector<complex<double>> residues(poles.size());
+    for (size_t i = 0; i < poles.size(); ++i) {
+        const complex<double> w = 1.0 / poles[i];
+        complex<double> numerator = 1;
+        for (const Biquad& biquad : parallel) {
+            numerator *= evalNumerator(biquad, w);
+        }
+        complex<double> denominator = 1;
+        for (size_t j = 0; j < poles.size(); ++j) {
+            if (j != i) {
+                denominator *= 1.0 - poles[j] * w;
+            }
+        }
+        residues[i] = numerator / denominator;
+    }
+
+    // Combine the residues of each section into c0 + c1 * z^-1 over the section's own denominator.
+    vector<double> c0s, c1s, a1s, a2s;
+    for (size_t i = 0; i < poles.size(); ++i) {
+        const size_t section = poleSections[i];
+        const bool isPair = i + 1 < poles.size() && poleSections[i + 1] == section;
+        complex<double> c0 = residues[i];
+        complex<double> c1 = 0;
+        if (isPair) {
+            c0 += residues[i + 1];
+            c1 = -(residues[i] * poles[i + 1] + residues[i + 1] * poles[i]);
+        }
+        c0s.push_back(c0.real());
+        c1s.push_back(c1.real());
+        a1s.push_back(parallel[section].getA1());
+        a2s.push_back(parallel[section].getA2());
+        if (isPair) {
+            ++i;
+        }
+    }
+
+    pResult->_numParallel = c0s.size();
+    pResult->_numGroups = (c0s.size() + SIMD_WIDTH - 1) / SIMD_WIDTH;
+    pResult->_pGroups = Simd::allocate<Group>(pResult->_numGroups);
+    for (size_t i = 0; i < pResult->_numGroups * SIMD_WIDTH; ++i) {
+        Group& group = pResult->_pGroups[i / SIMD_WIDTH];
+        const size_t lane = i % SIMD_WIDTH;
+        // Unused lanes have zero numerator and output nothing.
+        const bool isUsed = i < c0s.size();
+        group.c0[lane] = isUsed ? c0s[i] : 0;
+        group.c1[lane] = isUsed ? c1s[i] : 0;
+        group.a1[lane] = isUsed ? a1s[i] : 0;
+        group.a2[lane] = isUsed ? a2s[i] : 0;
+    }
+    pResult->reset();
+
+    // Verify that the impulse responses match.
+    vector<Biquad> reference = cascade;
+    for (Biquad& biquad : reference) {
+        biquad.reset();
+    }
+    vector<double> expected(VERIFY_LENGTH, 0.0), actual(VERIFY_LENGTH, 0.0);
+    expected[0] = actual[0] = 1;
+    for (Biquad& biquad : reference) {
+        biquad.process(expected.data(), expected.data(), VERIFY_LENGTH);
+    }
+    pResult->process(actual.data(), actual.data(), VERIFY_LENGTH);
+    pResult->reset();
+    double peak = 1;
+    for (const double value : expected) {
+        peak = std::max(peak, std::abs(value));
+    }
+    for (size_t i = 0; i < VERIFY_LENGTH; ++i) {
+        if (!(std::abs(expected[i] - actual[i]) <= VERIFY_TOLERANCE * peak)) {
+            return nullptr;
+        }
+    }
+    return pResult;
+}
+
+const size_t BiquadParallel::getNumParallel() const {
+    return _numParallel;
+}
+
+const size_t BiquadParallel::getNumSerial() const {
+    return _serial.size();
+}
+
+const double BiquadParallel::process(double value) {
+    for (Biquad& biquad : _serial) {
+        value = biquad.process(value);
+    }
+    double result = _direct * value;
+    for (size_t g = 0; g < _numGroups; ++g) {
+        Group& group = _pGroups[g];
+        for (size_t lane = 0; lane < SIMD_WIDTH; ++lane) {
+            const double out = value * group.c0[lane] + group.z1[lane];
+            group.z1[lane] = value * group.c1[lane] - out * group.a1[lane] + group.z2[lane];
+            group.z2[lane] = -out * group.a2[lane];
+            result += out;
+        }
+    }
+    return result;
+}
+
+void BiquadParallel::process(const double* const pIn, double* const pOut, const size_t numSamples) {
+    size_t offset = 0;
+    while (offset < numSamples) {
+        const size_t remaining = numSamples - offset;
+        const size_t count = remaining < BIQUAD_PARALLEL_CHUNK_SIZE ? remaining : BIQUAD_PARALLEL_CHUNK_SIZE;
+        memcpy(_input, pIn + offset, count * sizeof(double));
+        for (Biquad& biquad : _serial) {
+            biquad.process(_input, _input, count);
+        }
+        memset(_sums, 0, count * SIMD_WIDTH * sizeof(double));
+        for (size_t g = 0; g < _numGroups; ++g) {
+            processGroup(_pGroups[g], count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            pOut[offset + i] = _direct * _input[i] + Simd::sum(Simd::load(_sums + i * SIMD_WIDTH));
+        }
+        offset += count;
+    }
+}
+
+void BiquadParallel::reset() {
+    for (Biquad& biquad : _serial) {
+        biquad.reset();
+    }
+    for (size_t g = 0; g < _numGroups; ++g) {
+        memset(_pGroups[g].z1, 0, sizeof(_pGroups[g].z1));
+        memset(_pGroups[g].z2, 0, sizeof(_pGroups[g].z2));
+    }
+}
+
+void BiquadParallel::relocate(FilterArena& arena) {
+    arena.relocate(_pGroups, _numGroups);
+}
+
+void BiquadParallel::processGroup(Group& group, const size_t numSamples) {
+    const Simd::Vec c0 = Simd::load(group.c0);
+    const Simd::Vec c1 = Simd::load(group.c1);
+    const Simd::Vec a1 = Simd::load(group.a1);
+    const Simd::Vec a2 = Simd::load(group.a2);
+    Simd::Vec z1 = Simd::load(group.z1);
+    Simd::Vec z2 = Simd::load(group.z2);
+    for (size_t i = 0; i < numSamples; ++i) {
+        // Same input to every lane. Transposed direct form II.
+        const Simd::Vec in = Simd::set1(_input[i]);
+        const Simd::Vec out = Simd::mulAdd(in, c0, z1);
+        z1 = Simd::add(Simd::sub(Simd::mul(in, c1), Simd::mul(out, a1)), z2);
+        z2 = Simd::sub(Simd::zero(), Simd::mul(out, a2));
+        Simd::store(_sums + i * SIMD_WIDTH, Simd::add(Simd::load(_sums + i * SIMD_WIDTH), out));
+    }
+    Simd::store(group.z1, z1);
+    Simd::store(group.z2, z2);
+}
\ No newline at end of file
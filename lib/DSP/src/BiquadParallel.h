@@ -0,0 +1,56 @@
+/*
+    Biquad cascade converted to a parallel sum of second order sections using partial fraction expansion.
+    H(z) = serial(z) * (direct + sum(section(z)))
+    Parallel sections don't depend on each other and run in SIMD lanes. Sections whose poles repeat an
+    earlier section, like the second half of a Linkwitz-Riley crossover, stay in a short serial cascade.
+*/
+
+#pragma once
+#include <vector>
+#include <memory>
+#include "Biquad.h"
+#include "Simd.h"
+
+using std::vector;
+using std::unique_ptr;
+
+class FilterArena;
+
+#define BIQUAD_PARALLEL_CHUNK_SIZE 128
+// Shorter cascades are not worth converting.
+#define BIQUAD_PARALLEL_MIN_SECTIONS 3
+
+class BiquadParallel {
+public:
+
+    // Returns null if the cascade can't be converted or the parallel form doesn't match the cascade.
+    static unique_ptr<BiquadParallel> create(const vector<Biquad>& cascade);
+
+    const size_t getNumParallel() const;
+    const size_t getNumSerial() const;
+
+    const double process(double value);
+    // pIn and pOut can point to the same buffer.
+    void process(const double* const pIn, double* const pOut, const size_t numSamples);
+    void reset();
+    void relocate(FilterArena& arena);
+
+private:
+    // Coefficients and state for SIMD_WIDTH parallel sections. Numerator is c0 + c1 * z^-1.
+    struct Group {
+        double c0[SIMD_WIDTH], c1[SIMD_WIDTH], a1[SIMD_WIDTH], a2[SIMD_WIDTH];
+        double z1[SIMD_WIDTH], z2[SIMD_WIDTH];
+    };
+
+    vector<Biquad> _serial;
+    Simd::AlignedBuffer<Group> _pGroups;
+    double _direct;
+    size_t _numParallel, _numGroups;
+    double _input[BIQUAD_PARALLEL_CHUNK_SIZE];
+    double _sums[BIQUAD_PARALLEL_CHUNK_SIZE * SIMD_WIDTH];
+
+    BiquadParallel();
+
+    void processGroup(Group& group, const size_t numSamples);
+
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "BiquadStateSpace.h"
+#include "FilterArena.h"
+
+#define NUM_ROWS (BIQUAD_STATE_SPACE_VECTORS * SIMD_WIDTH)
+#define NUM_COLUMNS (BIQUAD_STATE_SPACE_BLOCK + 2)
+
+BiquadStateSpace::BiquadStateSpace(const Biquad& biquad) {
+    _biquad = biquad;
+    _biquad.reset();
+    _pMatrix = Simd::allocate(NUM_COLUMNS * NUM_ROWS);
+
+    // Each column is the response of the block to a unit input sample or a unit initial state.
+    // Simulate the biquad instead of forming matrix powers so the matrix matches the sample by sample result.
+    for (size_t column = 0; column < NUM_COLUMNS; ++column) {
+        Biquad section = _biquad;
+        section.setState(column == BIQUAD_STATE_SPACE_BLOCK ? 1 : 0, column == BIQUAD_STATE_SPACE_BLOCK + 1 ? 1 : 0);
+        double* const pColumn = _pMatrix.get() + column * NUM_ROWS;
+        for (size_t row = 0; row < BIQUAD_STATE_SPACE_BLOCK; ++row) {
+            pColumn[row] = section.process(row == column ? 1.0 : 0.0);
+        }
+        section.getState(pColumn[BIQUAD_STATE_SPACE_BLOCK], pColumn[BIQUAD_STATE_SPACE_BLOCK + 1]);
+    }
+}
+
+void BiquadStateSpace::process(const double* const pIn, double* const pOut, const size_t numSamples) {
+    const double* const pMatrix = _pMatrix.get();
+    double z1, z2;
+    _biquad.getState(z1, z2);
+    size_t i = 0;
+    for (; i + BIQUAD_STATE_SPACE_BLOCK <= numSamples; i += BIQUAD_STATE_SPACE_BLOCK) {
+        Simd::Vec result[BIQUAD_STATE_SPACE_VECTORS];
+        // Input part doesn't depend on the state and can run ahead of the recurrence.
+        for (size_t v = 0; v < BIQUAD_STATE_SPACE_VECTORS; ++v) {
+            result[v] = Simd::zero();
+        }
+        for (size_t column = 0; column < BIQUAD_STATE_SPACE_BLOCK; ++column) {
+            const Simd::Vec x = Simd::set1(pIn[i + column]);
+            const double* const pColumn = pMatrix + column * NUM_ROWS;
+            for (size_t v = 0; v < BIQUAD_STATE_SPACE_VECTORS; ++v) {
+                result[v] = Simd::mulAdd(Simd::loadAligned(pColumn + v * SIMD_WIDTH), x, result[v]);
+            }
+        }
+        const Simd::Vec s1 = Simd::set1(z1);
+        const Simd::Vec s2 = Simd::set1(z2);
+        const double* const pState1 = pMatrix + BIQUAD_STATE_SPACE_BLOCK * NUM_ROWS;
+        const double* const pState2 = pState1 + NUM_ROWS;
+        for (size_t v = 0; v < BIQUAD_STATE_SPACE_VECTORS; ++v) {
+            result[v] = Simd::mulAdd(Simd::loadAligned(pState1 + v * SIMD_WIDTH), s1, result[v]);
+            result[v] = Simd::mulAdd(Simd::loadAligned(pState2 + v * SIMD_WIDTH), s2, result[v]);
+        }
+        // All inputs of the block are read before any output is written.
+        for (size_t v = 0; v + 1 < BIQUAD_STATE_SPACE_VECTORS; ++v) {
+            Simd::store(pOut + i + v * SIMD_WIDTH, result[v]);
+        }
+        alignas(SIMD_WIDTH * sizeof(double)) double state[SIMD_WIDTH];
+        Simd::store(state, result[BIQUAD_STATE_SPACE_VECTORS - 1]);
+        z1 = state[0];
+        z2 = state[1];
+    }
+    _biquad.setState(z1, z2);
+    if (i < numSamples) {
+        _biquad.process(pIn + i, pOut + i, numSamples - i);
+    }
+}
+
+void BiquadStateSpace::relocate(FilterArena& arena) {
+    arena.relocate(_pMatrix, NUM_COLUMNS * NUM_ROWS);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+    State space block form of a biquad. Calculates BIQUAD_STATE_SPACE_BLOCK outputs at once from the
+    block input and the carried state with a precomputed matrix:
+    [y0 .. yN-1, z1', z2'] = M * [x0 .. xN-1, z1, z2]
+    The recurrence then only depends on the state once per block instead of once per sample.
+    State is the same as the transposed direct form II of Biquad, so the remainder of a block runs as a normal biquad.
+*/
+
+#pragma once
+#include "Biquad.h"
+#include "Simd.h"
+
+#define BIQUAD_STATE_SPACE_BLOCK (2 * SIMD_WIDTH)
+// Output rows plus one vector for the two state rows.
+#define BIQUAD_STATE_SPACE_VECTORS (BIQUAD_STATE_SPACE_BLOCK / SIMD_WIDTH + 1)
+
+class FilterArena;
+
+class BiquadStateSpace {
+public:
+
+    BiquadStateSpace(const Biquad& biquad);
+
+    inline const double process(const double value) {
+        return _biquad.process(value);
+    }
+
+    // pIn and pOut can point to the same buffer.
+    void process(const double* const pIn, double* const pOut, const size_t numSamples);
+
+    inline void reset() {
+        _biquad.reset();
+    }
+
+    void relocate(FilterArena& arena);
+
+private:
+    // Biquad for the remainder of a block and for the state.
+    Biquad _biquad;
+    // One column per input sample followed by one column for each state. Each column is BIQUAD_STATE_SPACE_VECTORS vectors.
+    Simd::AlignedBuffer<> _pMatrix;
+
+};
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "ConvolutionMatrix.h"
+#include <cstring>
+#include "Error.h"
+#include "FilterArena.h"
+
+ConvolutionMatrix::ConvolutionMatrix(const vector<Path>& paths, const size_t partitionSize)
+    : _fft(2 * partitionSize) {
+    if (paths.empty()) {
+        throw Error("Convolution matrix needs at least one path");
+    }
+    _partitionSize = partitionSize;
+    _numBins = _fft.getNumBins();
+    _stride = (2 * _numBins + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    _accumulator = Simd::allocate(_stride);
+    _timeBuffer = Simd::allocate(2 * partitionSize);
+
+    // Inverse transform is unscaled. Apply the scaling to the filter instead.
+    const double scale = 1.0 / _fft.getSize();
+    vector<complex<double>> spectrum(_numBins);
+    for (size_t pathIndex = 0; pathIndex < paths.size(); ++pathIndex) {
+        const Path& path = paths[pathIndex];
+        if (!path.taps.size()) {
+            throw Error("Partitioned convolution needs at least one tap");
+        }
+
+        // Inputs and outputs are stored in order of first use.
+        size_t inputIndex = 0;
+        while (inputIndex < _inputs.size() && _inputs[inputIndex].index != path.inputIndex) {
+            ++inputIndex;
+        }
+        if (inputIndex == _inputs.size()) {
+            Input input;
+            input.index = path.inputIndex;
+            input.numPartitions = input.delayLineIndex = 0;
+            _inputs.push_back(std::move(input));
+        }
+        size_t outputIndex = 0;
+        while (outputIndex < _outputs.size() && _outputs[outputIndex].index != path.outputIndex) {
+            ++outputIndex;
+        }
+        if (outputIndex == _outputs.size()) {
+            Output output;
+            output.index = path.outputIndex;
+            output.buffer = Simd::allocate(partitionSize);
+            _outputs.push_back(std::move(output));
+        }
+        _outputs[outputIndex].paths.push_back(pathIndex);
+
+        Spectra spectra;
+        spectra.input = inputIndex;
+        spectra.numPartitions = (path.taps.size() + partitionSize - 1) / partitionSize;
+        spectra.real = Simd::allocate(spectra.numPartitions * _stride);
+        spectra.imag = Simd::allocate(spectra.numPartitions * _stride);
+        spectra.zeroPartitions = vector<bool>(spectra.numPartitions);
+        for (size_t p = 0; p < spectra.numPartitions; ++p) {
+            const size_t start = p * partitionSize;
+            const size_t end = start + partitionSize < path.taps.size() ? start + partitionSize : path.taps.size();
+            bool isZero = true;
+            memset(_timeBuffer.get(), 0, 2 * partitionSize * sizeof(double));
+            for (size_t i = start; i < end; ++i) {
+                _timeBuffer[i - start] = path.taps[i] * scale;
+                if (path.taps[i] != 0.0) {
+                    isZero = false;
+                }
+            }
+            spectra.zeroPartitions[p] = isZero;
+            _fft.forward(_timeBuffer.get(), spectrum.data());
+            double* const pReal = spectra.real.get() + p * _stride;
+            double* const pImag = spectra.imag.get() + p * _stride;
+            for (size_t k = 0; k < _numBins; ++k) {
+                pReal[2 * k] = pReal[2 * k + 1] = spectrum[k].real();
+                pImag[2 * k] = -spectrum[k].imag();
+                pImag[2 * k + 1] = spectrum[k].imag();
+            }
+        }
+        if (spectra.numPartitions > _inputs[inputIndex].numPartitions) {
+            _inputs[inputIndex].numPartitions = spectra.numPartitions;
+        }
+        _spectra.push_back(std::move(spectra));
+    }
+
+    // The delay line of an input is as long as its longest path.
+    for (Input& input : _inputs) {
+        input.window = Simd::allocate(2 * partitionSize);
+        input.delayLine = Simd::allocate(input.numPartitions * _stride);
+    }
+
+    reset();
+}
+
+const size_t ConvolutionMatrix::getPartitionSize() const {
+    return _partitionSize;
+}
+
+const size_t ConvolutionMatrix::getNumPaths() const {
+    return _spectra.size();
+}
+
+const size_t ConvolutionMatrix::getNumInputs() const {
+    return _inputs.size();
+}
+
+const size_t ConvolutionMatrix::getNumOutputs() const {
+    return _outputs.size();
+}
+
+void ConvolutionMatrix::process(const double* const* const ppIn, double* const* const ppOut, const size_t numSamples) {
+    size_t offset = 0;
+    while (offset < numSamples) {
+        const size_t remaining = numSamples - offset;
+        const size_t available = _partitionSize - _bufferIndex;
+        const size_t count = remaining < available ? remaining : available;
+        for (Input& input : _inputs) {
+            memcpy(input.window.get() + _partitionSize + _bufferIndex, ppIn[input.index] + offset, count * sizeof(double));
+        }
+        for (const Output& output : _outputs) {
+            double* const pOut = ppOut[output.index] + offset;
+            const double* const pBuffer = output.buffer.get() + _bufferIndex;
+            for (size_t i = 0; i < count; ++i) {
+                pOut[i] += pBuffer[i];
+            }
+        }
+        _bufferIndex += count;
+        offset += count;
+        if (_bufferIndex == _partitionSize) {
+            processPartition();
+            _bufferIndex = 0;
+        }
+    }
+}
+
+void ConvolutionMatrix::reset() {
+    for (Input& input : _inputs) {
+        memset(input.window.get(), 0, 2 * _partitionSize * sizeof(double));
+        memset(input.delayLine.get(), 0, input.numPartitions * _stride * sizeof(double));
+        input.delayLineIndex = 0;
+    }
+    for (Output& output : _outputs) {
+        memset(output.buffer.get(), 0, _partitionSize * sizeof(double));
+    }
+    _bufferIndex = 0;
+}
+
+void ConvolutionMatrix::relocate(FilterArena& arena) {
+    for (Input& input : _inputs) {
+        arena.relocate(input.window, 2 * _partitionSize);
+        arena.relocate(input.delayLine, input.numPartitions * _stride);
+    }
+    for (Spectra& spectra : _spectra) {
+        arena.relocate(spectra.real, spectra.numPartitions * _stride);
+        arena.relocate(spectra.imag, spectra.numPartitions * _stride);
+    }
+    arena.relocate(_accumulator, _stride);
+    arena.relocate(_timeBuffer, 2 * _partitionSize);
+    for (Output& output : _outputs) {
+        arena.relocate(output.buffer, _partitionSize);
+    }
+}
+
+void ConvolutionMatrix::processPartition() {
+    // One forward transform per input. Newest spectrum goes into the current delay line slot.
+    for (Input& input : _inputs) {
+        _fft.forward(input.window.get(), (complex<double>*)(input.delayLine.get() + input.delayLineIndex * _stride));
+        memcpy(input.window.get(), input.window.get() + _partitionSize, _partitionSize * sizeof(double));
+    }
+
+    // Multiply accumulate every path to the output with the input spectrum of the same age. Then one inverse transform per output.
+    double* const pAcc = _accumulator.get();
+    for (Output& output : _outputs) {
+        memset(pAcc, 0, _stride * sizeof(double));
+        for (const size_t pathIndex : output.paths) {
+            const Spectra& spectra = _spectra[pathIndex];
+            const Input& input = _inputs[spectra.input];
+            for (size_t p = 0; p < spectra.numPartitions; ++p) {
+                if (spectra.zeroPartitions[p]) {
+                    continue;
+                }
+                const size_t slot = (input.delayLineIndex + input.numPartitions - p) % input.numPartitions;
+                const double* const pReal = spectra.real.get() + p * _stride;
+                const double* const pImag = spectra.imag.get() + p * _stride;
+                const double* const pX = input.delayLine.get() + slot * _stride;
+                for (size_t k = 0; k < _stride; k += SIMD_WIDTH) {
+                    const Simd::Vec x = Simd::loadAligned(pX + k);
+                    const Simd::Vec product = Simd::mulAdd(Simd::swapPairs(x), Simd::loadAligned(pImag + k), Simd::mul(x, Simd::loadAligned(pReal + k)));
+                    Simd::store(pAcc + k, Simd::add(Simd::loadAligned(pAcc + k), product));
+                }
+            }
+        }
+        // Overlap-save: the first half is circular aliasing, the second half is valid output.
+        _fft.inverse((const complex<double>*)pAcc, _timeBuffer.get());
+        memcpy(output.buffer.get(), _timeBuffer.get() + _partitionSize, _partitionSize * sizeof(double));
+    }
+
+    for (Input& input : _inputs) {
+        input.delayLineIndex = (input.delayLineIndex + 1) % input.numPartitions;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+    Uniformly partitioned overlap-save convolution of several inputs to several outputs.
+    Each path convolves one input with an impulse response and mixes the result into one output.
+    Every input block is transformed once and shared by all paths from that input, and all paths to an
+    output are multiply accumulated in the frequency domain before one inverse transform.
+    Costs numInputs + numOutputs FFTs per block instead of 2 * numPaths for separate convolvers.
+    Adds a latency of partitionSize samples, same as PartitionedConvolver.
+*/
+
+#pragma once
+#include "FFT.h"
+
+class FilterArena;
+
+class ConvolutionMatrix {
+public:
+
+    struct Path {
+        size_t inputIndex, outputIndex;
+        vector<double> taps;
+    };
+
+    ConvolutionMatrix(const vector<Path>& paths, const size_t partitionSize);
+
+    const size_t getPartitionSize() const;
+    const size_t getNumPaths() const;
+    const size_t getNumInputs() const;
+    const size_t getNumOutputs() const;
+
+    // ppIn and ppOut are indexed by the input and output index of the paths.
+    // The result is added to the output buffers. Input and output buffers can not overlap.
+    void process(const double* const* const ppIn, double* const* const ppOut, const size_t numSamples);
+    void reset();
+    void relocate(FilterArena& arena);
+
+private:
+    struct Input {
+        size_t index, numPartitions, delayLineIndex;
+        // Sliding window of the last two blocks and frequency domain delay line of numPartitions spectra.
+        Simd::AlignedBuffer<> window, delayLine;
+    };
+    struct Output {
+        size_t index;
+        vector<size_t> paths;
+        Simd::AlignedBuffer<> buffer;
+    };
+    struct Spectra {
+        size_t input, numPartitions;
+        // Partition spectra as real parts duplicated and imaginary parts with alternating sign. Ready for SIMD complex multiplication.
+        Simd::AlignedBuffer<> real, imag;
+        // Partitions that are all zero are skipped.
+        vector<bool> zeroPartitions;
+    };
+
+    FFT _fft;
+    vector<Input> _inputs;
+    vector<Output> _outputs;
+    vector<Spectra> _spectra;
+    Simd::AlignedBuffer<> _accumulator, _timeBuffer;
+    // Stride is the number of doubles per spectrum. 2 * numBins rounded up to a whole number of SIMD vectors.
+    size_t _partitionSize, _numBins, _stride, _bufferIndex;
+
+    void processPartition();
+
+};
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
+#include "Denormal.h"
 #include "FilterBiquad.h"
 #include "FilterCancellation.h"
 #include "FilterCompression.h"
 #include "FilterDelay.h"
 #include "FilterFir.h"
+#include "FilterFirZeroLatency.h"
 #include "FilterGain.h"
+#include "FilterMultirate.h"
+#include "FirDesign.h"
 #include "WaveHeader.h"
\ No newline at end of file
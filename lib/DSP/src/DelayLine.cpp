@@ -0,0 +1,26 @@
+#include "DelayLine.h"
+#include "FilterArena.h"
+
+DelayLine::DelayLine(const size_t maxDelay) {
+    // Room for the longest delay plus one written chunk.
+    size_t size = DELAY_LINE_CHUNK_SIZE;
+    while (size < maxDelay + DELAY_LINE_CHUNK_SIZE) {
+        size <<= 1;
+    }
+    _pPool = DelayPool::getShared();
+    _pBuffer = _pPool->allocate(size);
+    _mask = size - 1;
+    _index = 0;
+}
+
+const size_t DelayLine::getSize() const {
+    return _mask + 1;
+}
+
+void DelayLine::relocate(FilterArena& arena) {
+    const double* const pRing = _pBuffer;
+    arena.relocate(_pBuffer, _mask + 1);
+    if (_pBuffer != pRing) {
+        _pPool.reset();
+    }
+}
\ No newline at end of file
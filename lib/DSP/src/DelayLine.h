@@ -0,0 +1,74 @@
+/*
+    Delay line on a power of two ring buffer from the shared delay pool.
+    Indexing is done with a mask so there is no wrap branch per sample.
+    Blocks are written once and any number of delayed taps can be read back, each with at most two copies.
+*/
+
+#pragma once
+#include <memory>
+#include <cstring> // memcpy
+#include <algorithm> // min
+#include "DelayPool.h"
+
+// Max number of samples written per call to write().
+#define DELAY_LINE_CHUNK_SIZE 256
+
+using std::shared_ptr;
+
+class FilterArena;
+
+class DelayLine {
+public:
+
+    DelayLine(const size_t maxDelay = 0);
+
+    const size_t getSize() const;
+    // Move the ring from the shared pool into the arena.
+    void relocate(FilterArena& arena);
+
+    // Write a single sample.
+    inline void write(const double value) {
+        _pBuffer[_index & _mask] = value;
+        ++_index;
+    }
+
+    // Write a block of at most DELAY_LINE_CHUNK_SIZE samples.
+    inline void write(const double* const pIn, const size_t numSamples) {
+        copyIn(_index & _mask, pIn, numSamples);
+        _index += numSamples;
+    }
+
+    // Sample written delay samples before the last one.
+    inline const double read(const size_t delay) const {
+        return _pBuffer[(_index - 1 - delay) & _mask];
+    }
+
+    // The last written numSamples samples delayed by delay samples.
+    inline void read(double* const pOut, const size_t delay, const size_t numSamples) const {
+        copyOut((_index - numSamples - delay) & _mask, pOut, numSamples);
+    }
+
+    inline void reset() {
+        memset(_pBuffer, 0, (_mask + 1) * sizeof(double));
+        _index = 0;
+    }
+
+private:
+    // Null once relocated. The pool is freed when no delay line uses it anymore.
+    shared_ptr<DelayPool> _pPool;
+    double* _pBuffer;
+    size_t _mask, _index;
+
+    inline void copyIn(const size_t position, const double* const pIn, const size_t numSamples) {
+        const size_t first = std::min(numSamples, _mask + 1 - position);
+        memcpy(_pBuffer + position, pIn, first * sizeof(double));
+        memcpy(_pBuffer, pIn + first, (numSamples - first) * sizeof(double));
+    }
+
+    inline void copyOut(const size_t position, double* const pOut, const size_t numSamples) const {
+        const size_t first = std::min(numSamples, _mask + 1 - position);
+        memcpy(pOut, _pBuffer + position, first * sizeof(double));
+        memcpy(pOut + first, _pBuffer, (numSamples - first) * sizeof(double));
+    }
+
+};
\ No newline at end of file
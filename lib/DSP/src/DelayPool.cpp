@@ -0,0 +1,34 @@
+#include "DelayPool.h"
+
+weak_ptr<DelayPool> DelayPool::_sharedPool;
+
+const shared_ptr<DelayPool> DelayPool::getShared() {
+    shared_ptr<DelayPool> pPool = _sharedPool.lock();
+    if (!pPool) {
+        pPool = shared_ptr<DelayPool>(new DelayPool());
+        _sharedPool = pPool;
+    }
+    return pPool;
+}
+
+DelayPool::DelayPool() {
+    _pSlab = nullptr;
+    _used = DELAY_POOL_SLAB_SIZE;
+}
+
+double* DelayPool::allocate(const size_t size) {
+    // Large ring. Own slab.
+    if (size > DELAY_POOL_SLAB_SIZE) {
+        _slabs.push_back(Simd::allocate(size));
+        return _slabs.back().get();
+    }
+    // Current slab is full. Start a new one.
+    if (_used + size > DELAY_POOL_SLAB_SIZE) {
+        _slabs.push_back(Simd::allocate(DELAY_POOL_SLAB_SIZE));
+        _pSlab = _slabs.back().get();
+        _used = 0;
+    }
+    double* const pRing = _pSlab + _used;
+    _used += size;
+    return pRing;
+}
\ No newline at end of file
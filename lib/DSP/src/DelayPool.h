@@ -0,0 +1,37 @@
+/*
+    Pool of power of two ring buffers for delay lines.
+    Rings are carved out of a few large aligned slabs instead of one heap allocation per filter.
+    The pool lives as long as any delay line using it.
+*/
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "Simd.h"
+
+// Slab size in samples. Larger rings get a slab of their own.
+#define DELAY_POOL_SLAB_SIZE 65536
+
+using std::shared_ptr;
+using std::weak_ptr;
+using std::vector;
+
+class DelayPool {
+public:
+
+    // Pool shared by all delay lines currently alive.
+    static const shared_ptr<DelayPool> getShared();
+
+    // Zero initialized ring. Size must be a power of two.
+    double* allocate(const size_t size);
+
+private:
+    static weak_ptr<DelayPool> _sharedPool;
+
+    vector<Simd::AlignedBuffer<>> _slabs;
+    double* _pSlab;
+    size_t _used;
+
+    DelayPool();
+
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*
+    Protection against denormal numbers.
+    Filter states and envelopes decaying towards zero in silence end up as denormals, which are very slow on x86.
+    Flush to zero(FTZ) and denormals are zero(DAZ) are set per thread in the SSE control register.
+    Builds without SSE can add tiny noise to the signal instead so that states never decay that far.
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <immintrin.h>
+#define DENORMAL_FTZ
+#endif
+
+// Amplitude of injected noise. -400dB, far below anything audible but large enough to keep states normal.
+#define DENORMAL_NOISE_LEVEL 1e-20
+
+namespace Denormal {
+
+    inline const bool isFlushToZeroSupported() {
+#ifdef DENORMAL_FTZ
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Enable or disable FTZ and DAZ for the calling thread.
+    inline void setFlushToZero(const bool enable) {
+#ifdef DENORMAL_FTZ
+        _MM_SET_FLUSH_ZERO_MODE(enable ? _MM_FLUSH_ZERO_ON : _MM_FLUSH_ZERO_OFF);
+        _MM_SET_DENORMALS_ZERO_MODE(enable ? _MM_DENORMALS_ZERO_ON : _MM_DENORMALS_ZERO_OFF);
+#endif
+    }
+
+    // Add zero mean noise at DENORMAL_NOISE_LEVEL to block. Seed is the state of the random generator.
+    inline void addNoise(double* const pData, const size_t numSamples, uint32_t& seed) {
+        uint32_t state = seed;
+        for (size_t i = 0; i < numSamples; ++i) {
+            state = state * 1664525 + 1013904223;
+            pData[i] += (int32_t)state * (DENORMAL_NOISE_LEVEL / 2147483648.0);
+        }
+        seed = state;
+    }
+
+};
\ No newline at end of file
@@ -0,0 +1,239 @@
+// Before any header that includes math.h without the defines.
+#define _USE_MATH_DEFINES
+#include <math.h> // M_PI
+#include "FFT.h"
+#include <map>
+#include <algorithm> // swap
+#include "Error.h"
+
+using std::map;
+using std::weak_ptr;
+using std::make_shared;
+
+// Complex multiplication of interleaved values with a twiddle in split form. Real parts (wr, wr) and imaginary parts (-wi, wi).
+inline Simd::Vec multiply(const Simd::Vec v, const double* const pReal, const double* const pImag) {
+    return Simd::mulAdd(Simd::swapPairs(v), Simd::loadAligned(pImag), Simd::mul(v, Simd::loadAligned(pReal)));
+}
+
+const bool FFT::isPowerOfTwo(const size_t value) {
+    return value && !(value & (value - 1));
+}
+
+FFT::FFT(const size_t size) {
+    if (size < 4 || !isPowerOfTwo(size)) {
+        throw Error("FFT size must be a power of two: %zu", size);
+    }
+    _size = size;
+    // A real transform of size N is calculated as a complex transform of size N/2.
+    _halfSize = size / 2;
+    _pPlan = getPlan(_halfSize);
+    _buffer = Simd::allocate(2 * _halfSize);
+
+    _realTwiddles = vector<complex<double>>(_halfSize + 1);
+    for (size_t i = 0; i < _realTwiddles.size(); ++i) {
+        _realTwiddles[i] = std::polar(1.0, -2 * M_PI * i / _size);
+    }
+}
+
+const size_t FFT::getSize() const {
+    return _size;
+}
+
+const size_t FFT::getNumBins() const {
+    return _halfSize + 1;
+}
+
+void FFT::forward(const double* const pIn, complex<double>* const pOut) {
+    // Pack even samples as real and odd samples as imaginary part.
+    complex<double>* const pBuffer = (complex<double>*)_buffer.get();
+    permute(*_pPlan, (const complex<double>*)pIn, pBuffer, false);
+    transform(*_pPlan, pBuffer);
+    // Split into spectrum of even and odd samples and combine.
+    pOut[0] = complex<double>(pBuffer[0].real() + pBuffer[0].imag(), 0);
+    pOut[_halfSize] = complex<double>(pBuffer[0].real() - pBuffer[0].imag(), 0);
+    for (size_t k = 1; k < _halfSize; ++k) {
+        const complex<double> a = pBuffer[k];
+        const complex<double> b = std::conj(pBuffer[_halfSize - k]);
+        const complex<double> even = 0.5 * (a + b);
+        const complex<double> odd = complex<double>(0, -0.5) * (a - b);
+        pOut[k] = even + _realTwiddles[k] * odd;
+    }
+}
+
+void FFT::inverse(const complex<double>* const pIn, double* const pOut) {
+    // The inverse is the conjugate of the forward transform of the conjugate.
+    const vector<uint32_t>& bitReverse = _pPlan->bitReverse;
+    complex<double>* const pBuffer = (complex<double>*)_buffer.get();
+    for (size_t k = 0; k < _halfSize; ++k) {
+        const complex<double> a = pIn[k];
+        const complex<double> b = std::conj(pIn[_halfSize - k]);
+        const complex<double> even = a + b;
+        const complex<double> odd = (a - b) * std::conj(_realTwiddles[k]);
+        pBuffer[bitReverse[k]] = std::conj(even + complex<double>(0, 1) * odd);
+    }
+    transform(*_pPlan, pBuffer);
+    for (size_t i = 0; i < _halfSize; ++i) {
+        pOut[2 * i] = pBuffer[i].real();
+        pOut[2 * i + 1] = -pBuffer[i].imag();
+    }
+}
+
+void FFT::forward(const complex<double>* const pIn, complex<double>* const pOut) {
+    if (!_pComplexPlan) {
+        _pComplexPlan = getPlan(_size);
+    }
+    permute(*_pComplexPlan, pIn, pOut, false);
+    transform(*_pComplexPlan, pOut);
+}
+
+void FFT::inverse(const complex<double>* const pIn, complex<double>* const pOut) {
+    if (!_pComplexPlan) {
+        _pComplexPlan = getPlan(_size);
+    }
+    permute(*_pComplexPlan, pIn, pOut, true);
+    transform(*_pComplexPlan, pOut);
+    for (size_t i = 0; i < _size; ++i) {
+        pOut[i] = std::conj(pOut[i]);
+    }
+}
+
+const shared_ptr<const FFT::Plan> FFT::getPlan(const size_t size) {
+    // Plans alive are reused. Convolvers of all channels usually share one size.
+    static map<size_t, weak_ptr<const Plan>> plans;
+    shared_ptr<const Plan> pPlan = plans[size].lock();
+    if (pPlan) {
+        return pPlan;
+    }
+
+    shared_ptr<Plan> pNewPlan = make_shared<Plan>();
+    pNewPlan->size = size;
+    size_t numBits = 0;
+    while (((size_t)1 << numBits) < size) {
+        ++numBits;
+    }
+    pNewPlan->bitReverse = vector<uint32_t>(size);
+    for (size_t i = 0; i < size; ++i) {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < numBits; ++bit) {
+            if (i & ((size_t)1 << bit)) {
+                reversed |= (size_t)1 << (numBits - 1 - bit);
+            }
+        }
+        pNewPlan->bitReverse[i] = (uint32_t)reversed;
+    }
+
+    // The first stage has no twiddles. Radix-2 for odd powers of two, otherwise radix-4.
+    const size_t firstM = numBits % 2 ? 2 : 4;
+    size_t numTwiddles = 0;
+    for (size_t m = firstM; 4 * m <= size; m *= 4) {
+        numTwiddles += 12 * m;
+    }
+    pNewPlan->twiddles = Simd::allocate(std::max<size_t>(numTwiddles, 1));
+    double* pTwiddles = pNewPlan->twiddles.get();
+    for (size_t m = firstM; 4 * m <= size; m *= 4) {
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t k = 1; k <= 3; ++k) {
+                const complex<double> w = std::polar(1.0, -2 * M_PI * (double)(j * k) / (4 * m));
+                double* const pReal = pTwiddles + (k - 1) * 4 * m;
+                double* const pImag = pReal + 2 * m;
+                pReal[2 * j] = pReal[2 * j + 1] = w.real();
+                pImag[2 * j] = -w.imag();
+                pImag[2 * j + 1] = w.imag();
+            }
+        }
+        pTwiddles += 12 * m;
+    }
+
+    plans[size] = pNewPlan;
+    return pNewPlan;
+}
+
+void FFT::permute(const Plan& plan, const complex<double>* const pIn, complex<double>* const pOut, const bool conjugate) {
+    const uint32_t* const pBitReverse = plan.bitReverse.data();
+    if (pIn == pOut) {
+        for (size_t i = 0; i < plan.size; ++i) {
+            if (i < pBitReverse[i]) {
+                std::swap(pOut[i], pOut[pBitReverse[i]]);
+            }
+        }
+        if (conjugate) {
+            for (size_t i = 0; i < plan.size; ++i) {
+                pOut[i] = std::conj(pOut[i]);
+            }
+        }
+    }
+    else if (conjugate) {
+        for (size_t i = 0; i < plan.size; ++i) {
+            pOut[pBitReverse[i]] = std::conj(pIn[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < plan.size; ++i) {
+            pOut[pBitReverse[i]] = pIn[i];
+        }
+    }
+}
+
+void FFT::transform(const Plan& plan, complex<double>* const pData) {
+    // Forward transform in place. Input is in bit reversed order.
+    const size_t size = plan.size;
+    const complex<double> minusI(0, -1);
+    size_t m;
+    if ((size & 0x5555555555555555ull) == 0) {
+        // Odd power of two. Radix-2 stage without twiddles.
+        for (size_t i = 0; i < size; i += 2) {
+            const complex<double> a = pData[i];
+            const complex<double> b = pData[i + 1];
+            pData[i] = a + b;
+            pData[i + 1] = a - b;
+        }
+        m = 2;
+    }
+    else {
+        // Radix-4 stage without twiddles.
+        for (size_t i = 0; i + 4 <= size; i += 4) {
+            const complex<double> a0 = pData[i] + pData[i + 1];
+            const complex<double> a1 = pData[i] - pData[i + 1];
+            const complex<double> s = pData[i + 2] + pData[i + 3];
+            const complex<double> d = minusI * (pData[i + 2] - pData[i + 3]);
+            pData[i] = a0 + s;
+            pData[i + 1] = a1 + d;
+            pData[i + 2] = a0 - s;
+            pData[i + 3] = a1 - d;
+        }
+        m = 4;
+    }
+
+    // Radix-4 stages. Two radix-2 stages in one pass over the data with three complex multiplications per butterfly.
+    const Simd::Vec sign = Simd::setPairs(1, -1);
+    const double* pTwiddles = plan.twiddles.get();
+    double* const p = (double*)pData;
+    for (; 4 * m <= size; m *= 4) {
+        const size_t width = 2 * m;
+        const double* const pW1 = pTwiddles;
+        const double* const pW2 = pTwiddles + 2 * width;
+        const double* const pW3 = pTwiddles + 4 * width;
+        for (size_t group = 0; group < 2 * size; group += 4 * width) {
+            double* const p0 = p + group;
+            double* const p1 = p0 + width;
+            double* const p2 = p1 + width;
+            double* const p3 = p2 + width;
+            for (size_t j = 0; j < width; j += SIMD_WIDTH) {
+                const Simd::Vec x0 = Simd::load(p0 + j);
+                const Simd::Vec x1 = multiply(Simd::load(p1 + j), pW2 + j, pW2 + width + j);
+                const Simd::Vec x2 = multiply(Simd::load(p2 + j), pW1 + j, pW1 + width + j);
+                const Simd::Vec x3 = multiply(Simd::load(p3 + j), pW3 + j, pW3 + width + j);
+                const Simd::Vec a0 = Simd::add(x0, x1);
+                const Simd::Vec a1 = Simd::sub(x0, x1);
+                const Simd::Vec s = Simd::add(x2, x3);
+                // Multiplied by -i.
+                const Simd::Vec d = Simd::mul(Simd::swapPairs(Simd::sub(x2, x3)), sign);
+                Simd::store(p0 + j, Simd::add(a0, s));
+                Simd::store(p1 + j, Simd::add(a1, d));
+                Simd::store(p2 + j, Simd::sub(a0, s));
+                Simd::store(p3 + j, Simd::sub(a1, d));
+            }
+        }
+        pTwiddles += 6 * width;
+    }
+}
\ No newline at end of file
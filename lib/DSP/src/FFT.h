@@ -0,0 +1,59 @@
+/*
+    Fast Fourier transform for real and complex signals.
+    Size must be a power of two. Radix-4 decimation in time with a radix-2 step for odd powers of two.
+    Butterflies run on SIMD vectors of interleaved complex values.
+    Twiddle factors and bit reversal tables are calculated once per size and shared by all instances.
+    The transform is unscaled. inverse(forward(x)) returns x multiplied by size.
+*/
+
+#pragma once
+#include <vector>
+#include <complex>
+#include <memory>
+#include "Simd.h"
+
+using std::vector;
+using std::complex;
+using std::shared_ptr;
+
+class FFT {
+public:
+
+    static const bool isPowerOfTwo(const size_t value);
+
+    FFT(const size_t size);
+
+    const size_t getSize() const;
+    const size_t getNumBins() const;
+
+    // Real input of size samples to size / 2 + 1 complex bins.
+    void forward(const double* const pIn, complex<double>* const pOut);
+    // Size / 2 + 1 complex bins to real output of size samples.
+    void inverse(const complex<double>* const pIn, double* const pOut);
+
+    // Complex transforms of size points. pIn and pOut can point to the same buffer.
+    void forward(const complex<double>* const pIn, complex<double>* const pOut);
+    void inverse(const complex<double>* const pIn, complex<double>* const pOut);
+
+private:
+    // Tables for a complex transform of one size.
+    struct Plan {
+        size_t size;
+        vector<uint32_t> bitReverse;
+        // Per radix-4 stage with m butterflies: w^j, w^2j and w^3j for j < m.
+        // Each as real parts duplicated and imaginary parts with alternating sign, 2 * m doubles. Ready for SIMD complex multiplication.
+        Simd::AlignedBuffer<> twiddles;
+    };
+
+    shared_ptr<const Plan> _pPlan, _pComplexPlan;
+    // Twiddles used to split the complex transform into the real spectrum.
+    vector<complex<double>> _realTwiddles;
+    // Interleaved complex values.
+    Simd::AlignedBuffer<> _buffer;
+    size_t _size, _halfSize;
+
+    static const shared_ptr<const Plan> getPlan(const size_t size);
+    static void transform(const Plan& plan, complex<double>* const pData);
+    static void permute(const Plan& plan, const complex<double>* const pIn, complex<double>* const pOut, const bool conjugate);
+
+};
\ No newline at end of file
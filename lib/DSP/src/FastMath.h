@@ -0,0 +1,42 @@
+/*
+    Fast approximations of log2 and exp2 for control signals like compressor levels.
+    log2 max error is 1.5e-5(0.0001 dB), exp2 max relative error is 3.6e-6(0.00003 dB).
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstring> // memcpy
+#include <cmath> // floor
+
+namespace FastMath {
+
+    // Positive, normal numbers only.
+    inline double log2(const double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const int exponent = (int)((bits >> 52) & 0x7ff) - 1023;
+        // Mantissa as a number in [1, 2)
+        bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+        double mantissa;
+        memcpy(&mantissa, &bits, sizeof(mantissa));
+        const double t = mantissa - 1;
+        const double poly = 1.4390933260957348e-05 + t * (1.4415920770586264 + t * (-0.70725343245999
+            + t * (0.4115614793144381 + t * (-0.1898324432019447 + t * 0.043928626547457085))));
+        return exponent + poly;
+    }
+
+    // Value in range [-1000, 1000].
+    inline double exp2(const double value) {
+        const double whole = std::floor(value);
+        const double t = value - whole;
+        const double poly = 1.0000035971444179 + t * (0.6929695509360407 + t * (0.241621322643757
+            + t * (0.05171773548929905 + t * 0.013683982879847624)));
+        uint64_t bits;
+        memcpy(&bits, &poly, sizeof(bits));
+        bits += (uint64_t)(int64_t)whole << 52;
+        double result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+};
\ No newline at end of file
@@ -5,12 +5,26 @@
 using std::string;
 using std::vector;
 
+class FilterArena;
+
 class Filter {
 public:
     virtual ~Filter() {}
 
     virtual inline const double process(double value) = 0;
+    // Process a block of samples. pIn and pOut can point to the same buffer.
+    virtual void process(const double* const pIn, double* const pOut, const size_t numSamples) = 0;
     virtual inline void reset() = 0;
     virtual const vector<string> toString() const = 0;
+    // Delay in samples added to the signal. Used to time align outputs.
+    virtual const size_t getLatency() const {
+        return 0;
+    }
+    // Linear filters can be moved across each other and merged. Filters wrapping other filters are linear if all of them are.
+    virtual const bool isLinear() const {
+        return true;
+    }
+    // Move coefficients and state into the arena of the compiled filter graph. Filters without buffers do nothing.
+    virtual void relocate(FilterArena&) { }
 
 };
\ No newline at end of file
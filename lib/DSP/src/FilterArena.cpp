@@ -0,0 +1,93 @@
+#include "FilterArena.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#ifdef _WIN32
+// Large pages need the lock pages in memory privilege to be granted to the user and enabled in the process token.
+static const bool enableLockMemoryPrivilege() {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+    TOKEN_PRIVILEGES privileges;
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool result = LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+        && AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr)
+        && GetLastError() == ERROR_SUCCESS;
+    CloseHandle(token);
+    return result;
+}
+#endif
+
+FilterArena::FilterArena(const std::function<void(FilterArena&)>& relocateAll, const bool useLargePages) {
+    _pData = nullptr;
+    _size = _used = _numBuffers = 0;
+    _isLargePages = false;
+    // Measure
+    relocateAll(*this);
+    allocate(useLargePages);
+    // Relocate
+    _used = _numBuffers = 0;
+    relocateAll(*this);
+}
+
+FilterArena::~FilterArena() {
+    if (!_pData) {
+        return;
+    }
+#ifdef _WIN32
+    if (_isLargePages) {
+        VirtualFree(_pData, 0, MEM_RELEASE);
+        return;
+    }
+#endif
+    _mm_free(_pData);
+}
+
+const size_t FilterArena::getSize() const {
+    return _size;
+}
+
+const size_t FilterArena::getNumBuffers() const {
+    return _numBuffers;
+}
+
+const bool FilterArena::isLargePages() const {
+    return _isLargePages;
+}
+
+void* FilterArena::reserve(const size_t numBytes) {
+    // Each buffer starts on a cache line.
+    const size_t offset = (_used + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT;
+    _used = offset + numBytes;
+    ++_numBuffers;
+    return _pData ? _pData + offset : nullptr;
+}
+
+void FilterArena::allocate(const bool useLargePages) {
+    _size = _used > 0 ? _used : SIMD_ALIGNMENT;
+#ifdef _WIN32
+    if (useLargePages) {
+        const size_t pageSize = GetLargePageMinimum();
+        if (pageSize && enableLockMemoryPrivilege()) {
+            const size_t size = (_size + pageSize - 1) / pageSize * pageSize;
+            _pData = (char*)VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (_pData) {
+                _size = size;
+                _isLargePages = true;
+                return;
+            }
+        }
+    }
+#else
+    // Large pages are only supported on Windows.
+    (void)useLargePages;
+#endif
+    _pData = (char*)_mm_malloc(_size, SIMD_ALIGNMENT);
+    if (!_pData) {
+        throw std::bad_alloc();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+    One contiguous allocation holding the coefficients and state of a compiled filter graph.
+    The graph is walked twice in processing order. The first walk measures, the second moves every buffer into the arena,
+    so the memory touched while processing a block is laid out in the order it is used instead of scattered over the heap.
+    Every buffer starts on a cache line. The arena can be backed by large pages to cut TLB misses.
+    Relocated buffers don't own their memory. It is all freed at once with the arena, which must outlive the filters' use.
+*/
+
+#pragma once
+#include <functional>
+#include <cstring> // memcpy
+#include "Simd.h"
+
+class FilterArena {
+public:
+
+    // relocateAll is called once to measure and once to relocate. It must make the same relocate calls both times.
+    // Large pages fall back to normal pages if they are not available, eg. without the lock pages in memory privilege.
+    FilterArena(const std::function<void(FilterArena&)>& relocateAll, const bool useLargePages = false);
+    ~FilterArena();
+
+    // Size in bytes including alignment padding.
+    const size_t getSize() const;
+    const size_t getNumBuffers() const;
+    const bool isLargePages() const;
+
+    // Move a buffer of size elements into the arena. Does nothing while measuring.
+    template<typename T>
+    void relocate(T*& pBuffer, const size_t size) {
+        T* const p = (T*)reserve(size * sizeof(T));
+        if (p) {
+            memcpy(p, pBuffer, size * sizeof(T));
+            pBuffer = p;
+        }
+    }
+
+    // Move an owned buffer into the arena. The old memory is freed and the buffer no longer owns the new memory.
+    template<typename T>
+    void relocate(Simd::AlignedBuffer<T>& buffer, const size_t size) {
+        T* p = buffer.get();
+        relocate(p, size);
+        if (p != buffer.get()) {
+            buffer = Simd::AlignedBuffer<T>(p, Simd::AlignedDeleter(false));
+        }
+    }
+
+private:
+    char* _pData;
+    size_t _size, _used, _numBuffers;
+    bool _isLargePages;
+
+    // Returns null while measuring.
+    void* reserve(const size_t numBytes);
+    void allocate(const bool useLargePages);
+
+};
\ No newline at end of file
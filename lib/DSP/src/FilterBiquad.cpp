@@ -1,7 +1,10 @@
 #include "FilterBiquad.h"
 #include "Biquad.h"
 #include "CrossoverType.h"
+#include "Convert.h"
 #include "Str.h"
+#include "FilterArena.h"
+#include <cmath> // abs
 
 #ifndef LOG_INFO
 #include "Log.h"
@@ -9,6 +12,7 @@
 
 FilterBiquad::FilterBiquad(const uint32_t sampleRate) {
     _sampleRate = sampleRate;
+    _pCascade = nullptr;
 }
 
 const size_t FilterBiquad::size() const {
@@ -23,6 +27,45 @@ const uint32_t FilterBiquad::getSampleRate() const {
     return _sampleRate;
 }
 
+const vector<Biquad>& FilterBiquad::getBiquads() const {
+    return _biquads;
+}
+
+const bool FilterBiquad::compileParallel() {
+    _pParallel = BiquadParallel::create(_biquads);
+    return isParallel();
+}
+
+const bool FilterBiquad::isParallel() const {
+    return _pParallel != nullptr;
+}
+
+void FilterBiquad::compileStateSpace() {
+    _stateSpace.clear();
+    for (const Biquad& biquad : _biquads) {
+        _stateSpace.push_back(BiquadStateSpace(biquad));
+    }
+}
+
+void FilterBiquad::applyGain(const double multiplier) {
+    Biquad& biquad = _biquads.front();
+    biquad.init(biquad.getB0() * multiplier, biquad.getB1() * multiplier, biquad.getB2() * multiplier, biquad.getA1(), biquad.getA2());
+    _toStringValue.push_back(String::format(
+        "Gain: %sdB%s",
+        String::toString(Convert::levelToDb(std::abs(multiplier))).c_str(),
+        multiplier < 0 ? ", inverted" : ""
+    ));
+    // Compiled forms are copies of the sections.
+    if (_pParallel) {
+        if (!compileParallel()) {
+            compileStateSpace();
+        }
+    }
+    else if (!_stateSpace.empty()) {
+        compileStateSpace();
+    }
+}
+
 void FilterBiquad::add(const double b0, const double b1, const double b2, const double a1, const double a2) {
     Biquad biquad;
     biquad.init(b0, b1, b2, a1, a2);
@@ -234,5 +277,33 @@ void FilterBiquad::printCoefficients(const bool miniDSPFormat) const {
 }
 
 const vector<string> FilterBiquad::toString() const {
+    if (_pParallel) {
+        vector<string> result = _toStringValue;
+        result.push_back(String::format(
+            "Parallel form: %zd sections, %zd serial",
+            _pParallel->getNumParallel(), _pParallel->getNumSerial()
+        ));
+        return result;
+    }
+    if (!_stateSpace.empty()) {
+        vector<string> result = _toStringValue;
+        result.push_back("State space block form");
+        return result;
+    }
     return _toStringValue;
+}
+
+void FilterBiquad::relocate(FilterArena& arena) {
+    if (_pParallel) {
+        _pParallel->relocate(arena);
+        return;
+    }
+    if (!_stateSpace.empty()) {
+        for (BiquadStateSpace& section : _stateSpace) {
+            section.relocate(arena);
+        }
+        return;
+    }
+    _pCascade = _biquads.data();
+    arena.relocate(_pCascade, _biquads.size());
 }
\ No newline at end of file
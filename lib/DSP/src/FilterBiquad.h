@@ -1,7 +1,10 @@
 #pragma once
 #include <vector>
+#include <cstring> // memcpy
 #include "Filter.h"
 #include "Biquad.h"
+#include "BiquadParallel.h"
+#include "BiquadStateSpace.h"
 
 enum class CrossoverType;
 
@@ -13,6 +16,16 @@ public:
     const size_t size() const;
     const bool isEmpty() const;
     const uint32_t getSampleRate() const;
+    const vector<Biquad>& getBiquads() const;
+
+    // Run as parallel sections instead of a cascade if the conversion is numerically safe.
+    // Call after all sections are added. Returns true if the parallel form is used.
+    const bool compileParallel();
+    const bool isParallel() const;
+    // Run each section in state space block form. Call after all sections are added.
+    void compileStateSpace();
+    // Fold a gain multiplier into the b coefficients of the first section. Negative multiplier inverts.
+    void applyGain(const double multiplier);
 
     void add(const double b0, const double b1, const double b2, const double a1, const double a2);
     void add(const double b0, const double b1, const double b2, const double a0, const double a1, const double a2);
@@ -39,23 +52,78 @@ public:
     const vector<vector<double>> getFrequencyResponse(const uint32_t nPoints, const double fMin, const double fMax) const;
     void printCoefficients(const bool miniDSPFormat = false) const;
     const vector<string> toString() const override;
+    // The cascade is processed from its copy in the arena afterwards. getBiquads() still returns the coefficients.
+    void relocate(FilterArena& arena) override;
 
     inline const double process(double data) override {
-        for (Biquad &biquad : _biquads) {
-            data = biquad.process(data);
+        if (_pParallel) {
+            return _pParallel->process(data);
+        }
+        if (!_stateSpace.empty()) {
+            for (BiquadStateSpace& section : _stateSpace) {
+                data = section.process(data);
+            }
+            return data;
+        }
+        Biquad* const pCascade = getCascade();
+        for (size_t i = 0; i < _biquads.size(); ++i) {
+            data = pCascade[i].process(data);
         }
         return data;
     }
 
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        if (_biquads.empty()) {
+            if (pIn != pOut) {
+                memcpy(pOut, pIn, numSamples * sizeof(double));
+            }
+            return;
+        }
+        if (_pParallel) {
+            _pParallel->process(pIn, pOut, numSamples);
+            return;
+        }
+        // First section reads the input block. The rest of the cascade works in place.
+        const double* pData = pIn;
+        if (!_stateSpace.empty()) {
+            for (BiquadStateSpace& section : _stateSpace) {
+                section.process(pData, pOut, numSamples);
+                pData = pOut;
+            }
+            return;
+        }
+        Biquad* const pCascade = getCascade();
+        const size_t numSections = _biquads.size();
+        for (size_t i = 0; i < numSections; ++i) {
+            pCascade[i].process(pData, pOut, numSamples);
+            pData = pOut;
+        }
+    }
+
     inline void reset() override {
-        for (Biquad &biquad : _biquads) {
-            biquad.reset();
+        Biquad* const pCascade = getCascade();
+        for (size_t i = 0; i < _biquads.size(); ++i) {
+            pCascade[i].reset();
+        }
+        if (_pParallel) {
+            _pParallel->reset();
+        }
+        for (BiquadStateSpace& section : _stateSpace) {
+            section.reset();
         }
     }
 
 private:
     vector<Biquad> _biquads;
+    unique_ptr<BiquadParallel> _pParallel;
+    vector<BiquadStateSpace> _stateSpace;
+    // Cascade in the filter arena. Null until relocated.
+    Biquad* _pCascade;
     vector<string> _toStringValue;
     uint32_t _sampleRate;
 
+    inline Biquad* getCascade() {
+        return _pCascade ? _pCascade : _biquads.data();
+    }
+
 };
@@ -1,15 +1,14 @@
 #include "FilterCancellation.h"
+#include "FilterDelay.h"
 #include "FilterGain.h"
 #include "Str.h"
 
-using std::make_unique;
-
-FilterCancellation::FilterCancellation(const uint32_t sampleRate, const double frequency, const double gain) {
+FilterCancellation::FilterCancellation(const uint32_t sampleRate, const double frequency, const double gain)
+    : _delayLine(FilterDelay::getSampleDelay(sampleRate, 1000.0 / frequency)) {
     _frequency = frequency;
     _gain = gain;
-    const double delayMs = 1000.0 / frequency;
+    _size = FilterDelay::getSampleDelay(sampleRate, 1000.0 / frequency);
     _multiplier = -FilterGain::getMultiplier(gain);
-    _pFilterDelay = make_unique<FilterDelay>(sampleRate, delayMs);
 }
 
 const vector<string> FilterCancellation::toString() const {
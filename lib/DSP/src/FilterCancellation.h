@@ -1,8 +1,8 @@
 #pragma once
-#include "FilterDelay.h"
-#include <memory>
-
-using std::unique_ptr;
+#include "Filter.h"
+#include "DelayLine.h"
+#include <cstdint>
+#include <algorithm> // min
 
 class FilterCancellation : public Filter {
 public:
@@ -12,15 +12,33 @@ public:
     const vector<string> toString() const override;
 
     inline const double process(const double data) override {
-        return data + _pFilterDelay->process(data) * _multiplier;
+        _delayLine.write(data);
+        return data + _delayLine.read(_size) * _multiplier;
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        double delayed[DELAY_LINE_CHUNK_SIZE];
+        for (size_t offset = 0; offset < numSamples; offset += DELAY_LINE_CHUNK_SIZE) {
+            const size_t count = std::min<size_t>(numSamples - offset, DELAY_LINE_CHUNK_SIZE);
+            _delayLine.write(pIn + offset, count);
+            _delayLine.read(delayed, _size, count);
+            for (size_t i = 0; i < count; ++i) {
+                pOut[offset + i] = pIn[offset + i] + delayed[i] * _multiplier;
+            }
+        }
     }
 
     inline void reset() override {
-        _pFilterDelay->reset();
+        _delayLine.reset();
+    }
+
+    void relocate(FilterArena& arena) override {
+        _delayLine.relocate(arena);
     }
 
 private:
-    unique_ptr<FilterDelay> _pFilterDelay;
+    DelayLine _delayLine;
+    uint32_t _size;
     double _frequency, _gain, _multiplier;
 
 };
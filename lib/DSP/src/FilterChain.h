@@ -0,0 +1,155 @@
+/*
+    Fixed chain of filters stored by value. Calls to the stages are resolved at compile time,
+    so a whole chain is one virtual call per block instead of one per filter.
+    Use tryCreate to fuse a filter list that matches the chain shape.
+*/
+
+#pragma once
+#include <tuple>
+#include <memory>
+#include <typeinfo>
+#include <type_traits>
+#include "Filter.h"
+
+using std::unique_ptr;
+
+template<typename... Stages>
+class FilterChain : public Filter {
+public:
+
+    // Returns a chain with the filters moved into it if the list matches the stage types exactly. Otherwise null.
+    static unique_ptr<Filter> tryCreate(vector<unique_ptr<Filter>>& filters) {
+        if (filters.size() != sizeof...(Stages) || !matches<0>(filters)) {
+            return nullptr;
+        }
+        return create(filters, std::index_sequence_for<Stages...>());
+    }
+
+    FilterChain(Stages&&... stages) : _stages(std::move(stages)...) {}
+
+    const vector<string> toString() const override {
+        vector<string> result;
+        appendToString<0>(result);
+        return result;
+    }
+
+    inline const double process(const double value) override {
+        return processStage<0>(value);
+    }
+
+    // First stage reads the input block. The rest of the chain works in place.
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        std::get<0>(_stages).Stage<0>::process(pIn, pOut, numSamples);
+        processStages<1>(pOut, numSamples);
+    }
+
+    inline void reset() override {
+        resetStages<0>();
+    }
+
+    const size_t getLatency() const override {
+        return getStageLatency<0>();
+    }
+
+    const bool isLinear() const override {
+        return isStageLinear<0>();
+    }
+
+    void relocate(FilterArena& arena) override {
+        relocateStages<0>(arena);
+    }
+
+private:
+    static const size_t NUM_STAGES = sizeof...(Stages);
+
+    template<size_t I>
+    using Stage = typename std::tuple_element<I, std::tuple<Stages...>>::type;
+
+    std::tuple<Stages...> _stages;
+
+    template<size_t... I>
+    static unique_ptr<Filter> create(vector<unique_ptr<Filter>>& filters, std::index_sequence<I...>) {
+        unique_ptr<Filter> pResult = std::make_unique<FilterChain>(std::move(static_cast<Stage<I>&>(*filters[I]))...);
+        filters.clear();
+        return pResult;
+    }
+
+    template<size_t I>
+    static typename std::enable_if<I == NUM_STAGES, bool>::type matches(const vector<unique_ptr<Filter>>&) {
+        return true;
+    }
+
+    template<size_t I>
+    static typename std::enable_if<I < NUM_STAGES, bool>::type matches(const vector<unique_ptr<Filter>>& filters) {
+        return typeid (*filters[I]) == typeid (Stage<I>) && matches<I + 1>(filters);
+    }
+
+    template<size_t I>
+    inline typename std::enable_if<I == NUM_STAGES, double>::type processStage(const double value) {
+        return value;
+    }
+
+    // Qualified calls bypass the virtual dispatch.
+    template<size_t I>
+    inline typename std::enable_if<I < NUM_STAGES, double>::type processStage(const double value) {
+        return processStage<I + 1>(std::get<I>(_stages).Stage<I>::process(value));
+    }
+
+    template<size_t I>
+    inline typename std::enable_if<I == NUM_STAGES>::type processStages(double* const, const size_t) { }
+
+    template<size_t I>
+    inline typename std::enable_if<I < NUM_STAGES>::type processStages(double* const pData, const size_t numSamples) {
+        std::get<I>(_stages).Stage<I>::process(pData, pData, numSamples);
+        processStages<I + 1>(pData, numSamples);
+    }
+
+    template<size_t I>
+    inline typename std::enable_if<I == NUM_STAGES>::type resetStages() { }
+
+    template<size_t I>
+    inline typename std::enable_if<I < NUM_STAGES>::type resetStages() {
+        std::get<I>(_stages).Stage<I>::reset();
+        resetStages<I + 1>();
+    }
+
+    template<size_t I>
+    inline typename std::enable_if<I == NUM_STAGES>::type relocateStages(FilterArena&) { }
+
+    template<size_t I>
+    inline typename std::enable_if<I < NUM_STAGES>::type relocateStages(FilterArena& arena) {
+        std::get<I>(_stages).Stage<I>::relocate(arena);
+        relocateStages<I + 1>(arena);
+    }
+
+    template<size_t I>
+    typename std::enable_if<I == NUM_STAGES, size_t>::type getStageLatency() const {
+        return 0;
+    }
+
+    template<size_t I>
+    typename std::enable_if<I < NUM_STAGES, size_t>::type getStageLatency() const {
+        return std::get<I>(_stages).getLatency() + getStageLatency<I + 1>();
+    }
+
+    template<size_t I>
+    typename std::enable_if<I == NUM_STAGES, bool>::type isStageLinear() const {
+        return true;
+    }
+
+    template<size_t I>
+    typename std::enable_if<I < NUM_STAGES, bool>::type isStageLinear() const {
+        return std::get<I>(_stages).isLinear() && isStageLinear<I + 1>();
+    }
+
+    template<size_t I>
+    typename std::enable_if<I == NUM_STAGES>::type appendToString(vector<string>&) const { }
+
+    template<size_t I>
+    typename std::enable_if<I < NUM_STAGES>::type appendToString(vector<string>& result) const {
+        const vector<string> strings = std::get<I>(_stages).toString();
+        result.insert(result.end(), strings.begin(), strings.end());
+        appendToString<I + 1>(result);
+    }
+
+};
\ No newline at end of file
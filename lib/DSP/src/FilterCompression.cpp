@@ -4,21 +4,24 @@
 #include "Str.h"
 
 FilterCompression::FilterCompression(const uint32_t sampleRate, const double threshold, const double ratio,
-    const double attack, const double release, const double window) {
-    _threshold = Convert::dbToLevel(threshold);
+    const double attack, const double release, const double window, const size_t controlInterval) {
+    // Threshold in dB to log2 of the amplitude.
+    _thresholdLog2 = threshold / (20.0 * std::log10(2.0));
     _ratio = ratio - 1;
-    _squaredSum = 0;
-    _envelope = 0;
-    _attackCoef = exp(-1000.0 / (attack * sampleRate));
-    _releaseCoef = exp(-1000.0 / (release * sampleRate));
-    if (window > 0) {
-        _useWindow = true;
-        _windowCoef = exp(-1000.0 / (window * sampleRate));
-    }
-    else {
-        _useWindow = false;
-        _windowCoef = 0;
+    _controlInterval = controlInterval > 0 ? controlInterval : 1;
+    // Envelope is only updated once per control interval.
+    _attackCoef = exp(-1000.0 * _controlInterval / (attack * sampleRate));
+    _releaseCoef = exp(-1000.0 * _controlInterval / (release * sampleRate));
+    _useWindow = window > 0;
+    _windowSize = 0;
+    if (_useWindow) {
+        _windowSize = (size_t)std::round(window * sampleRate / 1000.0);
+        if (_windowSize < 1) {
+            _windowSize = 1;
+        }
+        _squares.resize(_windowSize);
     }
+    reset();
     _toStringValue = getToStringValue(threshold, ratio, attack, release, window);
 }
 
@@ -33,11 +36,12 @@ const string FilterCompression::getToStringValue(
     const double release,
     const double window) {
     return String::format(
-        "Compression: threshold %sdB, ratio %s, attack %sms, release %sms, window %sms",
+        "Compression: threshold %sdB, ratio %s, attack %sms, release %sms, window %sms, control interval %zd",
         String::toString(threshold).c_str(),
         String::toString(ratio).c_str(),
         String::toString(attack).c_str(),
         String::toString(release).c_str(),
-        String::toString(window).c_str()
+        String::toString(window).c_str(),
+        _controlInterval
     );
 }
\ No newline at end of file
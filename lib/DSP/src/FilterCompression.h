@@ -1,15 +1,19 @@
 /*
     Downward dynamic range compression
+    Level detection and gain calculation are done in the log2 domain at control rate.
+    Gain is linearly interpolated between control points.
 */
 
 #pragma once
 #include <cmath>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "Filter.h"
-#include "Convert.h"
+#include "FastMath.h"
 
-using std::pow;
-using std::sqrt;
+// Samples between gain calculations.
+#define COMPRESSION_CONTROL_INTERVAL 32
 
 class FilterCompression : public Filter {
 public:
@@ -20,45 +24,112 @@ public:
         const double ratio, // [0.0, 1.0] 0.0=oo:1, 0.5=2:1, 1.0=1:1
         const double attack, // ms
         const double release, // ms
-        const double window = 0 // ms
+        const double window = 0, // ms. Sliding RMS window. 0 uses peak level per control interval.
+        const size_t controlInterval = COMPRESSION_CONTROL_INTERVAL // samples
     );
 
     const vector<string> toString() const;
 
+    const bool isLinear() const override {
+        return false;
+    }
+
     inline const double process(const double sample) override {
-        double over;
-        // Use a sliding rms window to calculate how much the sample is over the threshold.
-        if (_useWindow) {
-            run(sample * sample, _windowCoef, _squaredSum);
-            over = sqrt(_squaredSum) / _threshold;
-        }
-        // Use just the single sample.
-        else {
-            over = sample * sample / _threshold;
-        }
-        if (over < 1) {
-            over = 1;
-        }
-        // Attack
-        if (over > _envelope) {
-            run(over, _attackCoef, _envelope);
-        }
-        // Release
-        else {
-            run(over, _releaseCoef, _envelope);
+        double result;
+        process(&sample, &result, 1);
+        return result;
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        double gain = _gain, gainStep = _gainStep;
+        size_t i = 0;
+        while (i < numSamples) {
+            const size_t remaining = numSamples - i;
+            const size_t available = _controlInterval - _counter;
+            const size_t count = remaining < available ? remaining : available;
+            const size_t end = i + count;
+            if (_useWindow) {
+                double sum = _sum;
+                size_t windowIndex = _windowIndex;
+                double* const pSquares = _squares.data();
+                for (; i < end; ++i) {
+                    const double sample = pIn[i];
+                    const double square = sample * sample;
+                    // Running sum of the sliding window.
+                    sum += square - pSquares[windowIndex];
+                    pSquares[windowIndex] = square;
+                    if (++windowIndex == _windowSize) {
+                        windowIndex = 0;
+                        // Recalculate once per window so rounding errors don't accumulate.
+                        sum = 0;
+                        for (size_t j = 0; j < _windowSize; ++j) {
+                            sum += pSquares[j];
+                        }
+                    }
+                    gain += gainStep;
+                    pOut[i] = sample * gain;
+                }
+                _sum = sum;
+                _windowIndex = windowIndex;
+            }
+            else {
+                double peak = _peak;
+                for (; i < end; ++i) {
+                    const double sample = pIn[i];
+                    const double square = sample * sample;
+                    peak = square > peak ? square : peak;
+                    gain += gainStep;
+                    pOut[i] = sample * gain;
+                }
+                _peak = peak;
+            }
+            _counter += count;
+            if (_counter == _controlInterval) {
+                _counter = 0;
+                _gain = gain;
+                updateGain();
+                gainStep = _gainStep;
+            }
         }
-        return sample * pow(over, _ratio);
+        _gain = gain;
     }
 
-    inline void reset() override { }
+    inline void reset() override {
+        _gain = 1;
+        _gainStep = 0;
+        _envelope = 0;
+        _peak = 0;
+        _sum = 0;
+        _counter = 0;
+        _windowIndex = 0;
+        std::fill(_squares.begin(), _squares.end(), 0.0);
+    }
 
 private:
-    double  _threshold, _ratio, _attackCoef, _releaseCoef, _windowCoef, _envelope, _squaredSum;
+    vector<double> _squares;
+    double _thresholdLog2, _ratio, _attackCoef, _releaseCoef, _envelope, _gain, _gainStep, _peak, _sum;
+    size_t _controlInterval, _counter, _windowSize, _windowIndex;
     bool _useWindow;
     string _toStringValue;
 
-    inline void run(const double in, const double coef, double& state) const {
-        state = in + coef * (state - in);
+    // Calculate the gain at the next control point from the level of the last interval.
+    inline void updateGain() {
+        const double meanSquare = _useWindow ? _sum / _windowSize : _peak;
+        _peak = 0;
+        // log2 of the amplitude. Offset avoids log of zero.
+        const double level = 0.5 * FastMath::log2(meanSquare + 1e-30);
+        double over = level - _thresholdLog2;
+        if (over < 0) {
+            over = 0;
+        }
+        // Attack when over the envelope, release otherwise.
+        _envelope = over + (over > _envelope ? _attackCoef : _releaseCoef) * (_envelope - over);
+        // Released all the way. Stop the decay before it reaches denormals.
+        if (_envelope < 1e-12) {
+            _envelope = 0;
+        }
+        const double target = FastMath::exp2(_ratio * _envelope);
+        _gainStep = (target - _gain) / _controlInterval;
     }
 
     const string getToStringValue(
@@ -68,6 +139,4 @@ private:
         const double release,
         const double window);
 
-};
-
-
+};
\ No newline at end of file
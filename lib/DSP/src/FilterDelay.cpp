@@ -3,8 +3,6 @@
 #include <cmath> // lround
 #include "Str.h"
 
-using std::make_unique;
-
 const uint32_t FilterDelay::getSampleDelay(const uint32_t sampleRate, double delay, const bool useUnitMeter) {
     // Value is in meter. Convert to milliseconds
     if (useUnitMeter) {
@@ -16,17 +14,18 @@ const uint32_t FilterDelay::getSampleDelay(const uint32_t sampleRate, double del
 FilterDelay::FilterDelay() {
     _delay = 0;
     _useUnitMeter = false;
-    _size = _index = 0;
-    _pBuffer = nullptr;
+    _size = 0;
 }
 
-FilterDelay::FilterDelay(const uint32_t sampleRate, const double delay, const bool useUnitMeter) {
+FilterDelay::FilterDelay(const uint32_t sampleRate, const double delay, const bool useUnitMeter)
+    : _delayLine(getSampleDelay(sampleRate, delay, useUnitMeter)) {
     _delay = delay;
     _useUnitMeter = useUnitMeter;
     _size = getSampleDelay(sampleRate, delay, useUnitMeter);
-    _index = 0;
-    _pBuffer = make_unique<double[]>(_size);
-    reset();
+}
+
+const uint32_t FilterDelay::getSize() const {
+    return _size;
 }
 
 const vector<string> FilterDelay::toString() const {
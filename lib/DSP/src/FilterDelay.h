@@ -1,9 +1,8 @@
 #pragma once
 #include "Filter.h"
+#include "DelayLine.h"
 #include <cstdint>
-#include <memory>
-
-using std::unique_ptr;
+#include <algorithm> // min
 
 class FilterDelay : public Filter {
 public:
@@ -14,23 +13,34 @@ public:
     FilterDelay(const uint32_t sampleRate, const double delay, const bool useUnitMeter = false);
 
     const vector<string> toString() const override;
+    // Delay in samples.
+    const uint32_t getSize() const;
 
     inline const double process(const double value) override {
-        if (_index == _size) {
-            _index = 0;
+        _delayLine.write(value);
+        return _delayLine.read(_size);
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        for (size_t offset = 0; offset < numSamples; offset += DELAY_LINE_CHUNK_SIZE) {
+            const size_t count = std::min<size_t>(numSamples - offset, DELAY_LINE_CHUNK_SIZE);
+            // Write before read. Supports in place processing.
+            _delayLine.write(pIn + offset, count);
+            _delayLine.read(pOut + offset, _size, count);
         }
-        const double out = _pBuffer[_index];
-        _pBuffer[_index++] = value;
-        return out;
     }
 
     inline void reset() override {
-        memset(_pBuffer.get(), 0, _size * sizeof(double));
+        _delayLine.reset();
+    }
+
+    void relocate(FilterArena& arena) override {
+        _delayLine.relocate(arena);
     }
 
 private:
-    uint32_t _size, _index;
-    unique_ptr<double[]> _pBuffer;
+    DelayLine _delayLine;
+    uint32_t _size;
     double _delay;
     bool _useUnitMeter;
 
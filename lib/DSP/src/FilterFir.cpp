@@ -1,17 +1,103 @@
 #include "FilterFir.h"
 #include "Str.h"
+#include "Convert.h"
+#include <cmath>
 
 using std::make_unique;
 
-FilterFir::FilterFir(const vector<double>& taps) {
+#define PRECISION_TEST_LENGTH 4096
+
+FilterFir::FilterFir(const vector<double>& taps, const size_t partitionSize, const bool useFloat, const size_t groupDelay) {
     _taps = taps;
     _size = taps.size();
-    _pDelay = make_unique<double[]>(_size);
+    _groupDelay = groupDelay;
+    _precisionLoss = -INFINITY;
+    if (partitionSize) {
+        _pConvolver = make_unique<PartitionedConvolver>(taps, partitionSize);
+    }
+    else if (useFloat) {
+        _pKernelFloat = make_unique<FirKernel<float>>(taps);
+        _precisionLoss = measurePrecisionLoss();
+    }
+    else {
+        _pKernel = make_unique<FirKernel<double>>(taps);
+    }
     reset();
 }
 
 const vector<string> FilterFir::toString() const {
+    if (_pConvolver) {
+        return vector<string>{
+            String::format("FIR: %zdtaps, FFT partition %zd, latency %zd samples", _size, _pConvolver->getPartitionSize(), getLatency())
+        };
+    }
+    if (_pKernelFloat) {
+        return vector<string>{
+            String::format("FIR: %zdtaps, float32, precision loss %.1f dB", _size, _precisionLoss)
+        };
+    }
     return vector<string>{
         String::format("FIR: %zdtaps", _size)
     };
+}
+
+const size_t FilterFir::getLatency() const {
+    return _groupDelay + (_pConvolver ? _pConvolver->getLatency() : 0);
+}
+
+const vector<double>& FilterFir::getTaps() const {
+    return _taps;
+}
+
+const size_t FilterFir::getPartitionSize() const {
+    return _pConvolver ? _pConvolver->getPartitionSize() : 0;
+}
+
+const bool FilterFir::getUseFloat() const {
+    return _pKernelFloat != nullptr;
+}
+
+const size_t FilterFir::getGroupDelay() const {
+    return _groupDelay;
+}
+
+const double FilterFir::getPrecisionLoss() const {
+    return _precisionLoss;
+}
+
+void FilterFir::relocate(FilterArena& arena) {
+    if (_pConvolver) {
+        _pConvolver->relocate(arena);
+    }
+    else if (_pKernelFloat) {
+        _pKernelFloat->relocate(arena);
+    }
+    else {
+        _pKernel->relocate(arena);
+    }
+}
+
+const double FilterFir::measurePrecisionLoss() const {
+    // Run the same noise through a double and a float kernel and compare the output.
+    FirKernel<double> reference(_taps);
+    FirKernel<float> test(_taps);
+    vector<double> input(PRECISION_TEST_LENGTH), expected(PRECISION_TEST_LENGTH), output(PRECISION_TEST_LENGTH);
+    uint32_t seed = 1;
+    for (double& value : input) {
+        seed = seed * 1664525 + 1013904223;
+        // Noise is float since the capture buffer is float.
+        value = (float)(seed / 2147483648.0 - 1);
+    }
+    reference.process(input.data(), expected.data(), PRECISION_TEST_LENGTH);
+    test.process(input.data(), output.data(), PRECISION_TEST_LENGTH);
+    double signal = 0, error = 0;
+    for (size_t i = 0; i < PRECISION_TEST_LENGTH; ++i) {
+        const double diff = output[i] - expected[i];
+        signal += expected[i] * expected[i];
+        error += diff * diff;
+    }
+    if (error == 0 || signal == 0) {
+        return -INFINITY;
+    }
+    return Convert::levelToDb(sqrt(error / signal));
 }
\ No newline at end of file
@@ -1,33 +1,78 @@
 #pragma once
 #include "Filter.h"
+#include "PartitionedConvolver.h"
+#include "FirKernel.h"
 #include <memory>
 
 using std::unique_ptr;
 
+// Default partition size of FFT convolution. Also its latency.
+#define FIR_FFT_PARTITION_SIZE 256
+
 class FilterFir : public Filter {
 public:
 
-    FilterFir(const vector<double> &taps);
+    // partitionSize 0 uses direct form. Otherwise uniformly partitioned FFT convolution, power of two.
+    // useFloat runs direct form in float32 instead of double.
+    // groupDelay is the delay of the taps themselves, eg. the center of a linear phase FIR. Included in the latency.
+    FilterFir(const vector<double> &taps, const size_t partitionSize = 0, const bool useFloat = false, const size_t groupDelay = 0);
 
     const vector<string> toString() const override;
 
+    const size_t getLatency() const override;
+    const vector<double>& getTaps() const;
+    // 0 for direct form.
+    const size_t getPartitionSize() const;
+    const bool getUseFloat() const;
+    const size_t getGroupDelay() const;
+    // RMS error of float32 processing relative to double in dB. -inf if running in double.
+    const double getPrecisionLoss() const;
+    void relocate(FilterArena& arena) override;
+
     inline const double process(const double value) override {
-        double result = value * _taps[0];
-        for (size_t i = _size - 1; i > 0; --i) {
-            _pDelay[i] = _pDelay[i - 1];
-            result += _pDelay[i] * _taps[i];
+        if (_pConvolver) {
+            double result;
+            _pConvolver->process(&value, &result, 1);
+            return result;
+        }
+        if (_pKernelFloat) {
+            return _pKernelFloat->process(value);
+        }
+        return _pKernel->process(value);
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        if (_pConvolver) {
+            _pConvolver->process(pIn, pOut, numSamples);
+        }
+        else if (_pKernelFloat) {
+            _pKernelFloat->process(pIn, pOut, numSamples);
+        }
+        else {
+            _pKernel->process(pIn, pOut, numSamples);
         }
-        _pDelay[0] = value;
-        return result;
     }
 
     inline void reset() override {
-        memset(_pDelay.get(), 0, _size * sizeof(double));
+        if (_pConvolver) {
+            _pConvolver->reset();
+        }
+        else if (_pKernelFloat) {
+            _pKernelFloat->reset();
+        }
+        else {
+            _pKernel->reset();
+        }
     }
 
 private:
     vector<double> _taps;
-    unique_ptr<double[]> _pDelay;
-    size_t _size;
+    unique_ptr<FirKernel<double>> _pKernel;
+    unique_ptr<FirKernel<float>> _pKernelFloat;
+    unique_ptr<PartitionedConvolver> _pConvolver;
+    size_t _size, _groupDelay;
+    double _precisionLoss;
+
+    const double measurePrecisionLoss() const;
 
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "FilterFirZeroLatency.h"
+#include "Str.h"
+#include "Error.h"
+
+using std::make_unique;
+
+FilterFirZeroLatency::FilterFirZeroLatency(const vector<double>& taps, const size_t headSize) {
+    if (!FFT::isPowerOfTwo(headSize)) {
+        throw Error("FIR head size must be a power of two: %zu", headSize);
+    }
+    _size = taps.size();
+    _headSize = headSize;
+
+    const size_t headEnd = _size < headSize ? _size : headSize;
+    _pHead = make_unique<FilterFir>(vector<double>(taps.begin(), taps.begin() + headEnd));
+
+    // Segment layout in units of headSize(H):
+    // partition H covers [H, 4H), partition 2H covers [4H, 8H), partition 4H covers [8H, 16H) and so on.
+    // A segment with partition size B has a latency of B and starts at an offset that is a multiple of B.
+    // The offset minus B is padded with zero partitions, which the convolver skips.
+    size_t start = headEnd;
+    size_t partitionSize = headSize;
+    while (start < _size) {
+        const bool isLast = partitionSize >= FIR_ZERO_LATENCY_MAX_PARTITION_SIZE;
+        const size_t length = isLast ? _size - start : (start == headSize ? 3 * headSize : start);
+        const size_t end = start + length < _size ? start + length : _size;
+        vector<double> segmentTaps(start - partitionSize, 0.0);
+        segmentTaps.insert(segmentTaps.end(), taps.begin() + start, taps.begin() + end);
+        _segments.push_back(make_unique<PartitionedConvolver>(segmentTaps, partitionSize));
+        start = end;
+        partitionSize *= 2;
+    }
+
+    reset();
+}
+
+const vector<string> FilterFirZeroLatency::toString() const {
+    if (_segments.empty()) {
+        return vector<string>{
+            String::format("FIR: %zdtaps, zero latency", _size)
+        };
+    }
+    return vector<string>{
+        String::format(
+            "FIR: %zdtaps, zero latency, %zd FFT segments(%zd - %zd)",
+            _size, _segments.size(), _segments.front()->getPartitionSize(), _segments.back()->getPartitionSize()
+        )
+    };
+}
+
+void FilterFirZeroLatency::relocate(FilterArena& arena) {
+    _pHead->relocate(arena);
+    for (const unique_ptr<PartitionedConvolver>& pSegment : _segments) {
+        pSegment->relocate(arena);
+    }
+}
\ No newline at end of file
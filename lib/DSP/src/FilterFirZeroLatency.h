@@ -0,0 +1,62 @@
+/*
+    FIR filter using non-uniformly partitioned convolution without added latency.
+    The head of the impulse response is computed in direct form. The tail is split into segments
+    of uniformly partitioned FFT convolution with doubling partition sizes. Each segment starts late
+    enough in the impulse response to hide the latency of its own partition size.
+*/
+
+#pragma once
+#include "FilterFir.h"
+
+#define FIR_ZERO_LATENCY_HEAD_SIZE 128
+#define FIR_ZERO_LATENCY_MAX_PARTITION_SIZE 4096
+#define FIR_ZERO_LATENCY_CHUNK_SIZE 256
+
+class FilterFirZeroLatency : public Filter {
+public:
+
+    // headSize is the number of direct form taps and the size of the smallest FFT partition, power of two.
+    FilterFirZeroLatency(const vector<double>& taps, const size_t headSize = FIR_ZERO_LATENCY_HEAD_SIZE);
+
+    const vector<string> toString() const override;
+    void relocate(FilterArena& arena) override;
+
+    inline const double process(const double value) override {
+        double result;
+        process(&value, &result, 1);
+        return result;
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        size_t offset = 0;
+        while (offset < numSamples) {
+            const size_t remaining = numSamples - offset;
+            const size_t count = remaining < FIR_ZERO_LATENCY_CHUNK_SIZE ? remaining : FIR_ZERO_LATENCY_CHUNK_SIZE;
+            // Keep a copy of the input since pIn and pOut can be the same buffer.
+            memcpy(_inputBuffer, pIn + offset, count * sizeof(double));
+            _pHead->process(_inputBuffer, pOut + offset, count);
+            for (const unique_ptr<PartitionedConvolver>& pSegment : _segments) {
+                pSegment->process(_inputBuffer, _segmentBuffer, count);
+                for (size_t i = 0; i < count; ++i) {
+                    pOut[offset + i] += _segmentBuffer[i];
+                }
+            }
+            offset += count;
+        }
+    }
+
+    inline void reset() override {
+        _pHead->reset();
+        for (const unique_ptr<PartitionedConvolver>& pSegment : _segments) {
+            pSegment->reset();
+        }
+    }
+
+private:
+    unique_ptr<FilterFir> _pHead;
+    vector<unique_ptr<PartitionedConvolver>> _segments;
+    double _inputBuffer[FIR_ZERO_LATENCY_CHUNK_SIZE];
+    double _segmentBuffer[FIR_ZERO_LATENCY_CHUNK_SIZE];
+    size_t _size, _headSize;
+
+};
\ No newline at end of file
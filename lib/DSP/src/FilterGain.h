@@ -20,6 +20,13 @@ public:
         return _multiplier * value;
     }
 
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) override {
+        const double multiplier = _multiplier;
+        for (size_t i = 0; i < numSamples; ++i) {
+            pOut[i] = multiplier * pIn[i];
+        }
+    }
+
     inline void reset() override { }
 
 private:
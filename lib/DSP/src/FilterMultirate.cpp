@@ -0,0 +1,130 @@
+#include "FilterMultirate.h"
+#include "Str.h"
+#include <cmath> // log2
+#include <cstring> // memcpy, memmove
+#include <algorithm> // min
+
+using std::move;
+
+const bool FilterMultirate::isValidFactor(const size_t factor) {
+    return factor == 2 || factor == 4 || factor == 8 || factor == 16;
+}
+
+FilterMultirate::FilterMultirate(const uint32_t sampleRate, const size_t factor, vector<unique_ptr<Filter>>& filters) {
+    _sampleRate = sampleRate;
+    _factor = factor;
+    for (unique_ptr<Filter>& pFilter : filters) {
+        _filters.push_back(move(pFilter));
+    }
+    filters.clear();
+    // The last stage has the narrowest transition band. Earlier stages only need to protect the final passband.
+    const size_t numStages = (size_t)std::log2(factor);
+    for (size_t i = 0; i < numStages; ++i) {
+        _stages.push_back(HalfBandFilter(0.2 / (double)(1 << (numStages - 1 - i))));
+    }
+    for (size_t i = 0; i <= numStages; ++i) {
+        _buffers.push_back(vector<double>(MULTIRATE_CHUNK_SIZE / (1 << i) + 2));
+    }
+    _outputQueue.resize(MULTIRATE_CHUNK_SIZE + 2 * _factor);
+    reset();
+}
+
+const vector<string> FilterMultirate::toString() const {
+    vector<string> result;
+    result.push_back(String::format(
+        "Multirate: 1/%zd rate %sHz, latency %zd samples",
+        _factor,
+        String::toString(_sampleRate / (double)_factor).c_str(),
+        getLatency()
+    ));
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        for (const string& str : pFilter->toString()) {
+            result.push_back("    " + str);
+        }
+    }
+    return result;
+}
+
+const size_t FilterMultirate::getFactor() const {
+    return _factor;
+}
+
+const size_t FilterMultirate::getLatency() const {
+    // Each stage delays both on the way down and on the way up.
+    size_t latency = 0;
+    for (size_t i = 0; i < _stages.size(); ++i) {
+        latency += 2 * _stages[i].getLatency() * (1 << i);
+    }
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        latency += pFilter->getLatency() * _factor;
+    }
+    return latency;
+}
+
+const bool FilterMultirate::isLinear() const {
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        if (!pFilter->isLinear()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const vector<unique_ptr<Filter>>& FilterMultirate::getFilters() const {
+    return _filters;
+}
+
+vector<unique_ptr<Filter>>& FilterMultirate::getFilters() {
+    return _filters;
+}
+
+void FilterMultirate::process(const double* const pIn, double* const pOut, const size_t numSamples) {
+    const size_t numStages = _stages.size();
+    for (size_t offset = 0; offset < numSamples; offset += MULTIRATE_CHUNK_SIZE) {
+        const size_t count = std::min<size_t>(numSamples - offset, MULTIRATE_CHUNK_SIZE);
+
+        // Decimate down to the reduced rate.
+        const double* pData = pIn + offset;
+        size_t reducedCount = count;
+        for (size_t i = 0; i < numStages; ++i) {
+            reducedCount = _stages[i].decimate(pData, reducedCount, _buffers[i + 1].data());
+            pData = _buffers[i + 1].data();
+        }
+
+        // Filter at the reduced rate in place.
+        double* const pReduced = _buffers[numStages].data();
+        for (const unique_ptr<Filter>& pFilter : _filters) {
+            pFilter->process(pReduced, pReduced, reducedCount);
+        }
+
+        // Interpolate back up to the full rate. The last stage writes directly to the output queue.
+        for (size_t i = numStages; i-- > 0;) {
+            double* const pTarget = i ? _buffers[i].data() : _outputQueue.data() + _queueSize;
+            _stages[i].interpolate(_buffers[i + 1].data(), reducedCount, pTarget);
+            reducedCount *= 2;
+        }
+        _queueSize += reducedCount;
+
+        // Samples not yet available stay in the queue until the next block.
+        memcpy(pOut + offset, _outputQueue.data(), count * sizeof(double));
+        _queueSize -= count;
+        memmove(_outputQueue.data(), _outputQueue.data() + count, _queueSize * sizeof(double));
+    }
+}
+
+void FilterMultirate::reset() {
+    for (HalfBandFilter& stage : _stages) {
+        stage.reset();
+    }
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        pFilter->reset();
+    }
+    // Decimators output on the first sample, so at least as many samples as consumed are always produced.
+    _queueSize = 0;
+}
+
+void FilterMultirate::relocate(FilterArena& arena) {
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        pFilter->relocate(arena);
+    }
+}
\ No newline at end of file
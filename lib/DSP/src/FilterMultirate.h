@@ -0,0 +1,55 @@
+/*
+    Runs a list of filters at a reduced sample rate.
+    The signal is decimated by a power of two with half-band stages, filtered and interpolated back to the full rate.
+    Meant for band limited outputs like subwoofers, where long filters become much cheaper at the lower rate.
+    Content above 40% of the reduced rate's Nyquist frequency is removed.
+*/
+
+#pragma once
+#include "Filter.h"
+#include "HalfBandFilter.h"
+#include <memory>
+
+using std::unique_ptr;
+
+// Max number of full rate samples processed at a time.
+#define MULTIRATE_CHUNK_SIZE 512
+
+class FilterMultirate : public Filter {
+public:
+
+    static const bool isValidFactor(const size_t factor);
+
+    // Filters must be created for sampleRate / factor. factor is 2, 4, 8 or 16.
+    FilterMultirate(const uint32_t sampleRate, const size_t factor, vector<unique_ptr<Filter>>& filters);
+
+    const vector<string> toString() const override;
+
+    const size_t getFactor() const;
+    // Latency in full rate samples added by the rate conversion and the inner filters.
+    const size_t getLatency() const override;
+    const bool isLinear() const override;
+    const vector<unique_ptr<Filter>>& getFilters() const;
+    vector<unique_ptr<Filter>>& getFilters();
+
+    inline const double process(const double value) override {
+        double result;
+        process(&value, &result, 1);
+        return result;
+    }
+
+    void process(const double* const pIn, double* const pOut, const size_t numSamples) override;
+    void reset() override;
+    void relocate(FilterArena& arena) override;
+
+private:
+    vector<unique_ptr<Filter>> _filters;
+    vector<HalfBandFilter> _stages;
+    // One buffer per rate.
+    vector<vector<double>> _buffers;
+    // Interpolated samples waiting to be output.
+    vector<double> _outputQueue;
+    size_t _factor, _queueSize;
+    uint32_t _sampleRate;
+
+};
\ No newline at end of file
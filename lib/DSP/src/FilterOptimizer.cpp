@@ -0,0 +1,194 @@
+#include "FilterOptimizer.h"
+#include "FilterBiquad.h"
+#include "FilterDelay.h"
+#include "FilterFir.h"
+#include "FilterGain.h"
+#include "FilterMultirate.h"
+#include "FirDesign.h"
+#include <typeinfo>
+#include <algorithm> // min
+#include <cmath> // pow, INFINITY
+
+using std::make_unique;
+using std::move;
+
+void FilterOptimizer::optimize(vector<unique_ptr<Filter>>& filters) {
+    size_t start = 0;
+    while (start < filters.size()) {
+        size_t end = getSegmentEnd(filters, start);
+        end = mergeFirs(filters, start, end);
+        end = absorbBiquads(filters, start, end);
+        end = foldGains(filters, start, end);
+        start = end + 1;
+    }
+    // Reduced rate filters are their own list.
+    for (const unique_ptr<Filter>& pFilter : filters) {
+        if (typeid (*pFilter) == typeid (FilterMultirate)) {
+            optimize(((FilterMultirate*)pFilter.get())->getFilters());
+        }
+    }
+}
+
+const bool FilterOptimizer::isLinear(const Filter& filter) {
+    return filter.isLinear();
+}
+
+const bool FilterOptimizer::isEqual(const Filter& a, const Filter& b) {
+    if (typeid (a) != typeid (b)) {
+        return false;
+    }
+    if (typeid (a) == typeid (FilterGain)) {
+        return ((const FilterGain&)a).getMultiplier() == ((const FilterGain&)b).getMultiplier();
+    }
+    if (typeid (a) == typeid (FilterDelay)) {
+        return ((const FilterDelay&)a).getSize() == ((const FilterDelay&)b).getSize();
+    }
+    if (typeid (a) == typeid (FilterBiquad)) {
+        const vector<Biquad>& biquadsA = ((const FilterBiquad&)a).getBiquads();
+        const vector<Biquad>& biquadsB = ((const FilterBiquad&)b).getBiquads();
+        if (biquadsA.size() != biquadsB.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < biquadsA.size(); ++i) {
+            const Biquad& x = biquadsA[i];
+            const Biquad& y = biquadsB[i];
+            if (x.getB0() != y.getB0() || x.getB1() != y.getB1() || x.getB2() != y.getB2() || x.getA1() != y.getA1() || x.getA2() != y.getA2()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (typeid (a) == typeid (FilterFir)) {
+        const FilterFir& x = (const FilterFir&)a;
+        const FilterFir& y = (const FilterFir&)b;
+        return x.getPartitionSize() == y.getPartitionSize() && x.getUseFloat() == y.getUseFloat() &&
+            x.getGroupDelay() == y.getGroupDelay() && x.getTaps() == y.getTaps();
+    }
+    return false;
+}
+
+const size_t FilterOptimizer::getSegmentEnd(const vector<unique_ptr<Filter>>& filters, const size_t start) {
+    size_t end = start;
+    while (end < filters.size() && isLinear(*filters[end])) {
+        ++end;
+    }
+    return end;
+}
+
+const size_t FilterOptimizer::find(const vector<unique_ptr<Filter>>& filters, const size_t start, const size_t end, const std::type_info& type) {
+    for (size_t i = start; i < end; ++i) {
+        if (typeid (*filters[i]) == type) {
+            return i;
+        }
+    }
+    return end;
+}
+
+const size_t FilterOptimizer::mergeFirs(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end) {
+    const size_t first = find(filters, start, end, typeid (FilterFir));
+    size_t next = find(filters, first + 1, end, typeid (FilterFir));
+    while (next < end) {
+        const FilterFir* pFirst = (FilterFir*)filters[first].get();
+        const FilterFir* pNext = (FilterFir*)filters[next].get();
+        // FFT convolution if any of them used it, with the smaller partition.
+        size_t partitionSize = pFirst->getPartitionSize();
+        if (!partitionSize || (pNext->getPartitionSize() && pNext->getPartitionSize() < partitionSize)) {
+            partitionSize = pNext->getPartitionSize();
+        }
+        filters[first] = make_unique<FilterFir>(
+            FirDesign::convolve(pFirst->getTaps(), pNext->getTaps()),
+            partitionSize,
+            pFirst->getUseFloat() && pNext->getUseFloat(),
+            pFirst->getGroupDelay() + pNext->getGroupDelay()
+        );
+        filters.erase(filters.begin() + next);
+        --end;
+        next = find(filters, next, end, typeid (FilterFir));
+    }
+    return end;
+}
+
+const size_t FilterOptimizer::absorbBiquads(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end) {
+    size_t firIndex = find(filters, start, end, typeid (FilterFir));
+    size_t index = find(filters, start, end, typeid (FilterBiquad));
+    while (firIndex < end && index < end) {
+        const FilterFir* pFir = (FilterFir*)filters[firIndex].get();
+        const FilterBiquad* pBiquad = (FilterBiquad*)filters[index].get();
+        // Untrimmed response. It is truncated by the error bound below.
+        vector<double> impulse = FirDesign::getImpulseResponse(pBiquad->getBiquads(), -INFINITY, FILTER_ABSORB_MAX_TAPS);
+        impulse.resize(getAbsorbSize(impulse));
+        const size_t numTaps = pFir->getTaps().size();
+        const double cost = getFirCost(numTaps + impulse.size() - 1, pFir->getPartitionSize()) - getFirCost(numTaps, pFir->getPartitionSize());
+        if (impulse.size() && cost < FILTER_COST_BIQUAD_SECTION * pBiquad->size()) {
+            filters[firIndex] = createFir(*pFir, FirDesign::convolve(pFir->getTaps(), impulse));
+            filters.erase(filters.begin() + index);
+            --end;
+            if (index < firIndex) {
+                --firIndex;
+            }
+        }
+        else {
+            ++index;
+        }
+        index = find(filters, index, end, typeid (FilterBiquad));
+    }
+    return end;
+}
+
+const size_t FilterOptimizer::foldGains(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end) {
+    size_t index = find(filters, start, end, typeid (FilterGain));
+    while (index < end) {
+        const double multiplier = ((FilterGain*)filters[index].get())->getMultiplier();
+        const size_t firIndex = find(filters, start, end, typeid (FilterFir));
+        const size_t biquadIndex = find(filters, start, end, typeid (FilterBiquad));
+        // Scaled FIR taps cost nothing. Otherwise the first biquad section.
+        if (firIndex < end) {
+            const FilterFir* pFir = (FilterFir*)filters[firIndex].get();
+            vector<double> taps = pFir->getTaps();
+            for (double& tap : taps) {
+                tap *= multiplier;
+            }
+            filters[firIndex] = createFir(*pFir, taps);
+        }
+        else if (biquadIndex < end) {
+            ((FilterBiquad*)filters[biquadIndex].get())->applyGain(multiplier);
+        }
+        // Unity gain does nothing.
+        else if (multiplier != 1.0) {
+            index = find(filters, index + 1, end, typeid (FilterGain));
+            continue;
+        }
+        filters.erase(filters.begin() + index);
+        --end;
+        index = find(filters, index, end, typeid (FilterGain));
+    }
+    return end;
+}
+
+const size_t FilterOptimizer::getAbsorbSize(const vector<double>& impulse) {
+    // For input with peak 1 the output error is at most the sum of the magnitudes of the removed taps.
+    double sum = 0;
+    for (const double tap : impulse) {
+        sum += std::abs(tap);
+    }
+    const double maxError = sum * pow(10, FILTER_ABSORB_ERROR_DB / 20.0);
+    double error = 0;
+    size_t size = impulse.size();
+    while (size > 1 && error + std::abs(impulse[size - 1]) <= maxError) {
+        error += std::abs(impulse[--size]);
+    }
+    // The response beyond the computed taps is unknown. A decaying response that is negligible for the whole
+    // second half is even smaller after it.
+    return size <= impulse.size() / 2 ? size : 0;
+}
+
+unique_ptr<FilterFir> FilterOptimizer::createFir(const FilterFir& filter, const vector<double>& taps) {
+    return make_unique<FilterFir>(taps, filter.getPartitionSize(), filter.getUseFloat(), filter.getGroupDelay());
+}
+
+const double FilterOptimizer::getFirCost(const size_t numTaps, const size_t partitionSize) {
+    if (partitionSize) {
+        return FILTER_COST_FIR_PARTITION * (double)((numTaps + partitionSize - 1) / partitionSize);
+    }
+    return (double)numTaps;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+    Simplifies a filter list without changing its output.
+    Gains are folded into FIR taps or biquad coefficients, FIRs are convolved into one
+    and biquads are absorbed into a FIR when that is cheaper than running them.
+    Filters are only moved across other linear filters. Compression splits the list.
+*/
+
+#pragma once
+#include "Filter.h"
+#include <memory>
+
+using std::unique_ptr;
+
+// Rough cost per sample in multiply-adds.
+#define FILTER_COST_BIQUAD_SECTION 5
+// Per FFT partition. One complex multiply-add per bin.
+#define FILTER_COST_FIR_PARTITION 4
+// Longest biquad impulse response considered for absorption into a FIR.
+#define FILTER_ABSORB_MAX_TAPS 65536
+// Largest error of an absorbed biquad's truncated impulse response, relative to its peak gain.
+// Bounds the output error for any input, far below the 24 bit noise floor(-144 dB).
+#define FILTER_ABSORB_ERROR_DB -200
+
+class FilterFir;
+class FilterBiquad;
+
+class FilterOptimizer {
+public:
+
+    static void optimize(vector<unique_ptr<Filter>>& filters);
+    // Linear filters can be moved across each other and gains, and can have their inputs summed.
+    static const bool isLinear(const Filter& filter);
+    // True if both filters give the same output for the same input. Filter types that can't be compared are never equal.
+    static const bool isEqual(const Filter& a, const Filter& b);
+
+private:
+    static const size_t getSegmentEnd(const vector<unique_ptr<Filter>>& filters, const size_t start);
+    static const size_t find(const vector<unique_ptr<Filter>>& filters, const size_t start, const size_t end, const std::type_info& type);
+
+    // Each returns the new end of the segment.
+    static const size_t mergeFirs(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end);
+    static const size_t absorbBiquads(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end);
+    static const size_t foldGains(vector<unique_ptr<Filter>>& filters, const size_t start, size_t end);
+
+    // Length of the impulse response with the truncation error below FILTER_ABSORB_ERROR_DB. 0 if it hasn't decayed enough.
+    static const size_t getAbsorbSize(const vector<double>& impulse);
+    static unique_ptr<FilterFir> createFir(const FilterFir& filter, const vector<double>& taps);
+    static const double getFirCost(const size_t numTaps, const size_t partitionSize);
+
+};
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "FirDesign.h"
+#define _USE_MATH_DEFINES
+#include <math.h> // M_PI
+#include <complex>
+#include <algorithm> // max, fill
+#include "FFT.h"
+#include "Window.h"
+#include "Error.h"
+
+using std::complex;
+
+const double FirDesign::getMagnitude(const vector<Biquad>& biquads, const double frequency) {
+    const complex<double> z1 = std::polar(1.0, -2 * M_PI * frequency);
+    const complex<double> z2 = z1 * z1;
+    complex<double> result = 1;
+    for (const Biquad& biquad : biquads) {
+        result *= (biquad.getB0() + biquad.getB1() * z1 + biquad.getB2() * z2) / (1.0 + biquad.getA1() * z1 + biquad.getA2() * z2);
+    }
+    return std::abs(result);
+}
+
+const vector<double> FirDesign::linearPhase(const vector<Biquad>& biquads, const size_t numTaps) {
+    if (numTaps < 3) {
+        throw Error("Linear phase FIR must have at least 3 taps: %zu", numTaps);
+    }
+    const size_t size = numTaps | 1;
+    const size_t center = size / 2;
+
+    // A dense grid keeps the time aliasing of the sampled response far below the window.
+    size_t fftSize = 4;
+    while (fftSize < 4 * size) {
+        fftSize *= 2;
+    }
+    FFT fft(fftSize);
+
+    // Real spectrum gives a zero phase impulse response centered on sample 0.
+    vector<complex<double>> spectrum(fft.getNumBins());
+    for (size_t i = 0; i < spectrum.size(); ++i) {
+        spectrum[i] = getMagnitude(biquads, i / (double)fftSize);
+    }
+    vector<double> impulse(fftSize);
+    fft.inverse(spectrum.data(), impulse.data());
+
+    // Shift the center to the middle of the FIR and window the tails.
+    const double beta = Window::kaiserBeta(LINEAR_PHASE_WINDOW_ATTENUATION);
+    vector<double> taps(size);
+    for (size_t i = 0; i < size; ++i) {
+        const size_t index = (i + fftSize - center) % fftSize;
+        const double position = (i - (double)center) / center;
+        taps[i] = impulse[index] / fftSize * Window::kaiser(position, beta);
+    }
+    return taps;
+}
+
+const vector<double> FirDesign::minimumPhase(const vector<double>& taps) {
+    // A large transform keeps the aliasing of the cepstrum low.
+    size_t fftSize = 4;
+    while (fftSize < 8 * taps.size()) {
+        fftSize *= 2;
+    }
+    FFT fft(fftSize);
+    vector<double> buffer(fftSize);
+    vector<complex<double>> spectrum(fft.getNumBins());
+    std::copy(taps.begin(), taps.end(), buffer.begin());
+    fft.forward(buffer.data(), spectrum.data());
+
+    // Real cepstrum from the log magnitude.
+    double peak = 0;
+    for (const complex<double>& bin : spectrum) {
+        peak = std::max(peak, std::abs(bin));
+    }
+    if (peak == 0) {
+        throw Error("Minimum phase conversion of a FIR without energy");
+    }
+    const double floor = peak * pow(10, MINIMUM_PHASE_FLOOR_DB / 20.0);
+    for (complex<double>& bin : spectrum) {
+        bin = std::log(std::max(std::abs(bin), floor));
+    }
+    fft.inverse(spectrum.data(), buffer.data());
+
+    // Fold the anti-causal part onto the causal part. Scaling of the inverse transform included.
+    const size_t halfSize = fftSize / 2;
+    buffer[0] /= fftSize;
+    for (size_t i = 1; i < halfSize; ++i) {
+        buffer[i] *= 2.0 / fftSize;
+    }
+    buffer[halfSize] /= fftSize;
+    std::fill(buffer.begin() + halfSize + 1, buffer.end(), 0.0);
+
+    // Back to a spectrum with the minimum phase and the original magnitude.
+    fft.forward(buffer.data(), spectrum.data());
+    for (complex<double>& bin : spectrum) {
+        bin = std::exp(bin);
+    }
+    fft.inverse(spectrum.data(), buffer.data());
+
+    vector<double> result(taps.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        result[i] = buffer[i] / fftSize;
+    }
+    result.resize(std::max<size_t>(getTailStart(result, MINIMUM_PHASE_TAIL_DB), 1));
+    return result;
+}
+
+const vector<double> FirDesign::getImpulseResponse(const vector<Biquad>& biquads, const double thresholdDb, const size_t maxSize) {
+    vector<double> result(maxSize);
+    result[0] = 1;
+    for (Biquad biquad : biquads) {
+        biquad.reset();
+        biquad.process(result.data(), result.data(), result.size());
+    }
+    result.resize(std::max<size_t>(getTailStart(result, thresholdDb), 1));
+    return result;
+}
+
+const vector<double> FirDesign::convolve(const vector<double>& a, const vector<double>& b) {
+    const size_t size = a.size() + b.size() - 1;
+    size_t fftSize = 4;
+    while (fftSize < size) {
+        fftSize *= 2;
+    }
+    FFT fft(fftSize);
+    vector<double> buffer(fftSize);
+    vector<complex<double>> spectrumA(fft.getNumBins()), spectrumB(fft.getNumBins());
+    std::copy(a.begin(), a.end(), buffer.begin());
+    fft.forward(buffer.data(), spectrumA.data());
+    std::fill(buffer.begin(), buffer.end(), 0.0);
+    std::copy(b.begin(), b.end(), buffer.begin());
+    fft.forward(buffer.data(), spectrumB.data());
+    for (size_t i = 0; i < spectrumA.size(); ++i) {
+        spectrumA[i] *= spectrumB[i];
+    }
+    fft.inverse(spectrumA.data(), buffer.data());
+    vector<double> result(size);
+    for (size_t i = 0; i < size; ++i) {
+        result[i] = buffer[i] / fftSize;
+    }
+    return result;
+}
+
+const double FirDesign::getEnergy(const vector<double>& taps) {
+    double result = 0;
+    for (const double tap : taps) {
+        result += tap * tap;
+    }
+    return result;
+}
+
+const size_t FirDesign::getHeadSize(const vector<double>& taps, const double thresholdDb) {
+    const double limit = getEnergy(taps) * pow(10, thresholdDb / 10.0);
+    double head = 0;
+    size_t size = 0;
+    while (size < taps.size() && head + taps[size] * taps[size] <= limit) {
+        head += taps[size] * taps[size];
+        ++size;
+    }
+    return size;
+}
+
+const size_t FirDesign::getTailStart(const vector<double>& taps, const double thresholdDb) {
+    const double limit = getEnergy(taps) * pow(10, thresholdDb / 10.0);
+    double tail = 0;
+    size_t size = taps.size();
+    while (size > 0 && tail + taps[size - 1] * taps[size - 1] <= limit) {
+        tail += taps[size - 1] * taps[size - 1];
+        --size;
+    }
+    return size;
+}
+
+const pair<size_t, size_t> FirDesign::getTrimRange(const vector<double>& taps, const double thresholdDb) {
+    // Each end gets half of the energy budget.
+    const double endThresholdDb = thresholdDb + 10 * log10(0.5);
+    return pair<size_t, size_t>(getHeadSize(taps, endThresholdDb), getTailStart(taps, endThresholdDb));
+}
\ No newline at end of file
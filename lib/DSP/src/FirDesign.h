@@ -0,0 +1,52 @@
+/*
+    FIR filter design from biquad prototypes and conversion of existing FIRs.
+*/
+
+#pragma once
+#include "Biquad.h"
+#include <vector>
+#include <utility> // pair
+
+using std::vector;
+using std::pair;
+
+// Default length of a linear phase FIR.
+#define LINEAR_PHASE_TAPS 8191
+// Window applied to the truncated impulse response.
+#define LINEAR_PHASE_WINDOW_ATTENUATION 50
+// Magnitude floor relative to the peak in the minimum phase conversion. Keeps the log finite.
+#define MINIMUM_PHASE_FLOOR_DB -200
+// Trailing taps of a minimum phase FIR are removed while their energy is below this, relative to the total.
+#define MINIMUM_PHASE_TAIL_DB -120
+// Default energy threshold for trimming loaded FIRs, relative to the total.
+#define FIR_TRIM_THRESHOLD_DB -140
+
+namespace FirDesign {
+
+    // Magnitude response of the biquad cascade at a frequency relative to the sample rate, [0, 0.5].
+    const double getMagnitude(const vector<Biquad>& biquads, const double frequency);
+
+    // Symmetric FIR with the magnitude response of the biquad cascade.
+    // numTaps is rounded up to odd, so the group delay is (numTaps - 1) / 2 samples.
+    const vector<double> linearPhase(const vector<Biquad>& biquads, const size_t numTaps);
+
+    // Minimum phase FIR with the magnitude response of the taps, calculated with the real cepstrum.
+    // The energy is moved to the start of the filter and the negligible tail is removed.
+    const vector<double> minimumPhase(const vector<double>& taps);
+
+    // Impulse response of the biquad cascade until the tail holds less than thresholdDb of the energy. At most maxSize taps.
+    const vector<double> getImpulseResponse(const vector<Biquad>& biquads, const double thresholdDb, const size_t maxSize);
+
+    // Linear convolution of two FIRs. Calculated with FFT.
+    const vector<double> convolve(const vector<double>& a, const vector<double>& b);
+
+    // Sum of the squared taps.
+    const double getEnergy(const vector<double>& taps);
+    // Number of leading taps that together hold less than thresholdDb of the energy.
+    const size_t getHeadSize(const vector<double>& taps, const double thresholdDb);
+    // Number of leading taps that hold all but thresholdDb of the energy.
+    const size_t getTailStart(const vector<double>& taps, const double thresholdDb);
+    // First and one past the last tap to keep. The removed taps at both ends together hold less than thresholdDb of the energy.
+    const pair<size_t, size_t> getTrimRange(const vector<double>& taps, const double thresholdDb);
+
+};
\ No newline at end of file
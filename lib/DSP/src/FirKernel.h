@@ -0,0 +1,96 @@
+/*
+    Direct form FIR kernel templated over the sample type of taps, delay line and accumulation.
+    float uses twice the SIMD width and half the memory bandwidth of double.
+    Input and output are always double.
+*/
+
+#pragma once
+#include <vector>
+#include "Simd.h"
+#include "FilterArena.h"
+
+using std::vector;
+
+// Samples written into the delay line before calculating their outputs.
+#define FIR_DIRECT_CHUNK_SIZE 64
+
+template<typename T>
+class FirKernel {
+public:
+
+    FirKernel(const vector<double>& taps) {
+        _size = taps.size();
+        _paddedSize = (_size + 2 * WIDTH - 1) / (2 * WIDTH) * (2 * WIDTH);
+        _pTaps = Simd::allocate<T>(_paddedSize);
+        for (size_t i = 0; i < _size; ++i) {
+            _pTaps[i] = (T)taps[i];
+        }
+        _capacity = _paddedSize + FIR_DIRECT_CHUNK_SIZE;
+        _pDelay = Simd::allocate<T>(2 * _capacity);
+        reset();
+    }
+
+    inline const double process(const double value) {
+        write(&value, 1);
+        return dotProduct(_index);
+    }
+
+    inline void process(const double* const pIn, double* const pOut, const size_t numSamples) {
+        size_t offset = 0;
+        while (offset < numSamples) {
+            const size_t remaining = numSamples - offset;
+            const size_t count = remaining < FIR_DIRECT_CHUNK_SIZE ? remaining : FIR_DIRECT_CHUNK_SIZE;
+            // Write the whole chunk first. Reading a window right after storing into it stalls store forwarding.
+            size_t index = _index;
+            write(pIn + offset, count);
+            for (size_t i = 0; i < count; ++i) {
+                index = index ? index - 1 : _capacity - 1;
+                pOut[offset + i] = dotProduct(index);
+            }
+            offset += count;
+        }
+    }
+
+    inline void reset() {
+        memset(_pDelay.get(), 0, 2 * _capacity * sizeof(T));
+        _index = 0;
+    }
+
+    void relocate(FilterArena& arena) {
+        arena.relocate(_pTaps, _paddedSize);
+        arena.relocate(_pDelay, 2 * _capacity);
+    }
+
+private:
+    static const size_t WIDTH = Simd::Traits<T>::width;
+    typedef typename Simd::Traits<T>::Vector Vector;
+
+    // Taps zero padded to a multiple of two SIMD vectors.
+    Simd::AlignedBuffer<T> _pTaps;
+    // Circular delay line stored twice in a row so a window of padded size samples is always contiguous.
+    // Capacity leaves room for a chunk of new samples on top of the window.
+    Simd::AlignedBuffer<T> _pDelay;
+    size_t _size, _paddedSize, _capacity, _index;
+
+    inline void write(const double* const pIn, const size_t numSamples) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            _index = _index ? _index - 1 : _capacity - 1;
+            _pDelay[_index] = (T)pIn[i];
+            _pDelay[_index + _capacity] = (T)pIn[i];
+        }
+    }
+
+    inline const double dotProduct(const size_t index) const {
+        // pWindow[i] is the input from i samples ago.
+        const T* const pWindow = _pDelay.get() + index;
+        const T* const pTaps = _pTaps.get();
+        Vector sum1 = Simd::Traits<T>::zero();
+        Vector sum2 = Simd::Traits<T>::zero();
+        for (size_t i = 0; i < _paddedSize; i += 2 * WIDTH) {
+            sum1 = Simd::mulAdd(Simd::loadAligned(pTaps + i), Simd::load(pWindow + i), sum1);
+            sum2 = Simd::mulAdd(Simd::loadAligned(pTaps + i + WIDTH), Simd::load(pWindow + i + WIDTH), sum2);
+        }
+        return Simd::sum(Simd::add(sum1, sum2));
+    }
+
+};
\ No newline at end of file
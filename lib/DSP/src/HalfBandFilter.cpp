@@ -0,0 +1,119 @@
+#include "HalfBandFilter.h"
+#define _USE_MATH_DEFINES
+#include <math.h> // M_PI
+#include <cmath>
+#include <cstring> // memcpy, memmove
+#include <algorithm> // fill, max
+#include "Window.h"
+
+HalfBandFilter::HalfBandFilter(const double passband) {
+    // Kaiser window design. Transition band is symmetric around a quarter of the sample rate.
+    // The window gets some extra attenuation, since the length estimate falls short for short filters.
+    const double attenuation = HALF_BAND_ATTENUATION + HALF_BAND_DESIGN_MARGIN;
+    const double transition = 0.5 - 2 * passband;
+    const double beta = Window::kaiserBeta(attenuation);
+    const size_t length = (size_t)std::ceil((attenuation - 7.95) / (14.36 * transition)) + 1;
+    // Length 4 * numPairs - 1 puts zeros at both ends.
+    _numPairs = (length + 4) / 4;
+    design(beta);
+    // Grow the filter until the stopband meets the attenuation.
+    while (getStopbandLevel(passband) > -HALF_BAND_ATTENUATION) {
+        ++_numPairs;
+        design(beta);
+    }
+    _decimatePhase = 0;
+}
+
+const size_t HalfBandFilter::getNumTaps() const {
+    return 4 * _numPairs - 1;
+}
+
+const size_t HalfBandFilter::getLatency() const {
+    return 2 * _numPairs - 1;
+}
+
+const size_t HalfBandFilter::decimate(const double* const pIn, const size_t numSamples, double* const pOut) {
+    const size_t historySize = getNumTaps() - 1;
+    const size_t centerOffset = 2 * _numPairs - 1;
+    if (_decimateBuffer.size() < historySize + numSamples) {
+        _decimateBuffer.resize(historySize + numSamples);
+    }
+    double* const pBuffer = _decimateBuffer.data();
+    const double* const pTaps = _taps.data();
+    memcpy(pBuffer + historySize, pIn, numSamples * sizeof(double));
+    size_t count = 0;
+    size_t position = historySize + _decimatePhase;
+    for (; position < historySize + numSamples; position += 2) {
+        // Position is the newest sample in the window.
+        const double* const pCenter = pBuffer + position - centerOffset;
+        double sum = 0.5 * pCenter[0];
+        for (size_t i = 0; i < _numPairs; ++i) {
+            sum += pTaps[i] * (pCenter[-(ptrdiff_t)(2 * i + 1)] + pCenter[2 * i + 1]);
+        }
+        pOut[count++] = sum;
+    }
+    _decimatePhase = position - (historySize + numSamples);
+    memmove(pBuffer, pBuffer + numSamples, historySize * sizeof(double));
+    return count;
+}
+
+void HalfBandFilter::interpolate(const double* const pIn, const size_t numSamples, double* const pOut) {
+    // Zero stuffing leaves two phases. Even outputs use all the side taps, odd outputs only the center tap.
+    const size_t historySize = 2 * _numPairs - 1;
+    if (_interpolateBuffer.size() < historySize + numSamples) {
+        _interpolateBuffer.resize(historySize + numSamples);
+    }
+    double* const pBuffer = _interpolateBuffer.data();
+    const double* const pTaps = _taps.data();
+    memcpy(pBuffer + historySize, pIn, numSamples * sizeof(double));
+    for (size_t i = 0; i < numSamples; ++i) {
+        // Newest input sample is pNewest[0]. Window is 2 * numPairs samples.
+        const double* const pNewest = pBuffer + historySize + i;
+        double sum = 0;
+        for (size_t j = 0; j < _numPairs; ++j) {
+            sum += pTaps[j] * (pNewest[-(ptrdiff_t)(_numPairs - 1 - j)] + pNewest[-(ptrdiff_t)(_numPairs + j)]);
+        }
+        // Gain of two makes up for the zero stuffed samples.
+        pOut[2 * i] = 2 * sum;
+        pOut[2 * i + 1] = pNewest[-(ptrdiff_t)(_numPairs - 1)];
+    }
+    memmove(pBuffer, pBuffer + numSamples, historySize * sizeof(double));
+}
+
+void HalfBandFilter::reset() {
+    std::fill(_decimateBuffer.begin(), _decimateBuffer.end(), 0.0);
+    std::fill(_interpolateBuffer.begin(), _interpolateBuffer.end(), 0.0);
+    _decimatePhase = 0;
+}
+
+void HalfBandFilter::design(const double beta) {
+    _taps.clear();
+    const double center = 2.0 * _numPairs - 1;
+    double sum = 0;
+    for (size_t i = 0; i < _numPairs; ++i) {
+        // Odd distances from the center.
+        const double distance = 2.0 * i + 1;
+        const double sinc = std::sin(M_PI * distance / 2) / (M_PI * distance);
+        _taps.push_back(sinc * Window::kaiser(distance / center, beta));
+        sum += 2 * _taps.back();
+    }
+    // Unity gain at DC. The center tap is 0.5.
+    for (double& tap : _taps) {
+        tap *= 0.5 / sum;
+    }
+}
+
+const double HalfBandFilter::getStopbandLevel(const double passband) const {
+    // Frequencies relative to the sample rate. The stopband starts where the passband mirrors around a quarter.
+    const size_t numPoints = 2048;
+    double level = 0;
+    for (size_t i = 0; i <= numPoints; ++i) {
+        const double frequency = 0.5 - passband * i / numPoints;
+        double response = 0.5;
+        for (size_t j = 0; j < _numPairs; ++j) {
+            response += 2 * _taps[j] * std::cos(2 * M_PI * frequency * (2.0 * j + 1));
+        }
+        level = std::max(level, std::abs(response));
+    }
+    return 20 * std::log10(level);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/*
+    Linear phase half-band FIR for decimation and interpolation by two.
+    Every other tap of a half-band filter is zero, except the center tap which is 0.5.
+    Only the non zero taps are evaluated and symmetric taps share one multiplication.
+    Decimation and interpolation have separate states so the same stage can be used on both sides of a reduced rate domain.
+*/
+
+#pragma once
+#include <vector>
+
+using std::vector;
+
+// Stopband attenuation in dB.
+#define HALF_BAND_ATTENUATION 100.0
+// Extra attenuation the window is designed for. Keeps the filters short while meeting HALF_BAND_ATTENUATION.
+#define HALF_BAND_DESIGN_MARGIN 10.0
+
+class HalfBandFilter {
+public:
+
+    // passband is the edge of the passband relative to the input sample rate of the decimator. Must be less than 0.25.
+    HalfBandFilter(const double passband);
+
+    const size_t getNumTaps() const;
+    // Group delay in samples at the high rate.
+    const size_t getLatency() const;
+
+    // Returns number of samples written to pOut. Every other input sample produces an output sample.
+    const size_t decimate(const double* const pIn, const size_t numSamples, double* const pOut);
+    // Writes 2 * numSamples samples to pOut.
+    void interpolate(const double* const pIn, const size_t numSamples, double* const pOut);
+    void reset();
+
+private:
+    // Non zero side taps, from the center outwards. Same on both sides of the center.
+    vector<double> _taps;
+    // Input history followed by the current block.
+    vector<double> _decimateBuffer, _interpolateBuffer;
+    size_t _numPairs, _decimatePhase;
+
+    // Kaiser windowed taps for the current number of pairs.
+    void design(const double beta);
+    // Max response in dB over the stopband.
+    const double getStopbandLevel(const double passband) const;
+
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "Interleave.h"
+#include "Simd.h"
+
+// 4 floats to 4 doubles and back.
+#if defined(__AVX__)
+static inline void storeAsDouble(double* const p, const __m128 v) {
+    _mm256_storeu_pd(p, _mm256_cvtps_pd(v));
+}
+
+static inline __m128 loadAsFloat(const double* const p) {
+    return _mm256_cvtpd_ps(_mm256_loadu_pd(p));
+}
+#else
+static inline void storeAsDouble(double* const p, const __m128 v) {
+    _mm_storeu_pd(p, _mm_cvtps_pd(v));
+    _mm_storeu_pd(p + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+}
+
+static inline __m128 loadAsFloat(const double* const p) {
+    return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(p)), _mm_cvtpd_ps(_mm_loadu_pd(p + 2)));
+}
+#endif
+
+// Four frames at a time. Channels in groups of four are transposed as a 4x4 block, remaining channels are copied one by one.
+// With the channel count known at compile time all offsets are constants and the loops over channels are unrolled.
+template<size_t NumChannels>
+static void deinterleaveFixed(const float* const pIn, double* const* const ppOut, const size_t, const size_t numSamples) {
+    const size_t numGrouped = NumChannels / 4 * 4;
+    double* pOut[NumChannels];
+    for (size_t i = 0; i < NumChannels; ++i) {
+        pOut[i] = ppOut[i];
+    }
+    size_t sampleIndex = 0;
+    for (; sampleIndex + 4 <= numSamples; sampleIndex += 4) {
+        const float* const pFrames = pIn + sampleIndex * NumChannels;
+        for (size_t i = 0; i < numGrouped; i += 4) {
+            __m128 row0 = _mm_loadu_ps(pFrames + i);
+            __m128 row1 = _mm_loadu_ps(pFrames + NumChannels + i);
+            __m128 row2 = _mm_loadu_ps(pFrames + 2 * NumChannels + i);
+            __m128 row3 = _mm_loadu_ps(pFrames + 3 * NumChannels + i);
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            storeAsDouble(pOut[i] + sampleIndex, row0);
+            storeAsDouble(pOut[i + 1] + sampleIndex, row1);
+            storeAsDouble(pOut[i + 2] + sampleIndex, row2);
+            storeAsDouble(pOut[i + 3] + sampleIndex, row3);
+        }
+        for (size_t i = numGrouped; i < NumChannels; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                pOut[i][sampleIndex + j] = pFrames[j * NumChannels + i];
+            }
+        }
+    }
+    for (; sampleIndex < numSamples; ++sampleIndex) {
+        for (size_t i = 0; i < NumChannels; ++i) {
+            pOut[i][sampleIndex] = pIn[sampleIndex * NumChannels + i];
+        }
+    }
+}
+
+template<size_t NumChannels>
+static void interleaveFixed(const double* const* const ppIn, float* const pOut, const size_t, const size_t numSamples) {
+    const size_t numGrouped = NumChannels / 4 * 4;
+    const double* pIn[NumChannels];
+    for (size_t i = 0; i < NumChannels; ++i) {
+        pIn[i] = ppIn[i];
+    }
+    size_t sampleIndex = 0;
+    for (; sampleIndex + 4 <= numSamples; sampleIndex += 4) {
+        float* const pFrames = pOut + sampleIndex * NumChannels;
+        for (size_t i = 0; i < numGrouped; i += 4) {
+            __m128 row0 = loadAsFloat(pIn[i] + sampleIndex);
+            __m128 row1 = loadAsFloat(pIn[i + 1] + sampleIndex);
+            __m128 row2 = loadAsFloat(pIn[i + 2] + sampleIndex);
+            __m128 row3 = loadAsFloat(pIn[i + 3] + sampleIndex);
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            _mm_storeu_ps(pFrames + i, row0);
+            _mm_storeu_ps(pFrames + NumChannels + i, row1);
+            _mm_storeu_ps(pFrames + 2 * NumChannels + i, row2);
+            _mm_storeu_ps(pFrames + 3 * NumChannels + i, row3);
+        }
+        for (size_t i = numGrouped; i < NumChannels; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                pFrames[j * NumChannels + i] = (float)pIn[i][sampleIndex + j];
+            }
+        }
+    }
+    for (; sampleIndex < numSamples; ++sampleIndex) {
+        for (size_t i = 0; i < NumChannels; ++i) {
+            pOut[sampleIndex * NumChannels + i] = (float)pIn[i][sampleIndex];
+        }
+    }
+}
+
+const Interleave::Deinterleaver Interleave::getDeinterleaver(const size_t numChannels) {
+    switch (numChannels) {
+    case 2:
+        return deinterleaveFixed<2>;
+    case 4:
+        return deinterleaveFixed<4>;
+    case 6:
+        return deinterleaveFixed<6>;
+    case 8:
+        return deinterleaveFixed<8>;
+    case 12:
+        return deinterleaveFixed<12>;
+    case 16:
+        return deinterleaveFixed<16>;
+    case 24:
+        return deinterleaveFixed<24>;
+    default:
+        return deinterleave;
+    }
+}
+
+const Interleave::Interleaver Interleave::getInterleaver(const size_t numChannels) {
+    switch (numChannels) {
+    case 2:
+        return interleaveFixed<2>;
+    case 4:
+        return interleaveFixed<4>;
+    case 6:
+        return interleaveFixed<6>;
+    case 8:
+        return interleaveFixed<8>;
+    case 12:
+        return interleaveFixed<12>;
+    case 16:
+        return interleaveFixed<16>;
+    case 24:
+        return interleaveFixed<24>;
+    default:
+        return interleave;
+    }
+}
+
+const bool Interleave::isSpecialized(const size_t numChannels) {
+    return getDeinterleaver(numChannels) != deinterleave;
+}
+
+void Interleave::deinterleave(const float* const pIn, double* const* const ppOut, const size_t numChannels, const size_t numSamples) {
+    for (size_t i = 0; i < numChannels; ++i) {
+        double* const pOut = ppOut[i];
+        const float* pSample = pIn + i;
+        for (size_t sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex) {
+            pOut[sampleIndex] = *pSample;
+            pSample += numChannels;
+        }
+    }
+}
+
+void Interleave::interleave(const double* const* const ppIn, float* const pOut, const size_t numChannels, const size_t numSamples) {
+    for (size_t i = 0; i < numChannels; ++i) {
+        const double* const pIn = ppIn[i];
+        float* pSample = pOut + i;
+        for (size_t sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex) {
+            *pSample = (float)pIn[sampleIndex];
+            pSample += numChannels;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+/*
+    Conversion between the interleaved float frames of an audio device and one double block per channel.
+    Common channel counts are compiled with the count as a template argument and convert four frames at a time,
+    transposing groups of four channels with SIMD. Other counts fall back to a generic loop over one channel at a time.
+    The function is picked once from the device format, not per block.
+*/
+
+#pragma once
+#include <cstddef>
+
+namespace Interleave {
+
+    typedef void(*Deinterleaver)(const float* const pIn, double* const* const ppOut, const size_t numChannels, const size_t numSamples);
+    typedef void(*Interleaver)(const double* const* const ppIn, float* const pOut, const size_t numChannels, const size_t numSamples);
+
+    // Specialized for 2, 4, 6, 8, 12, 16 and 24 channels. Generic function for other channel counts.
+    const Deinterleaver getDeinterleaver(const size_t numChannels);
+    const Interleaver getInterleaver(const size_t numChannels);
+    const bool isSpecialized(const size_t numChannels);
+
+    // Generic versions for any channel count.
+    void deinterleave(const float* const pIn, double* const* const ppOut, const size_t numChannels, const size_t numSamples);
+    void interleave(const double* const* const ppIn, float* const pOut, const size_t numChannels, const size_t numSamples);
+
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "Latency.h"
+#include "FilterDelay.h"
+#include <algorithm> // max
+
+const size_t Latency::getLatency(const vector<unique_ptr<Filter>>& filters) {
+    size_t result = 0;
+    for (const unique_ptr<Filter>& pFilter : filters) {
+        result += pFilter->getLatency();
+    }
+    return result;
+}
+
+const size_t Latency::align(const uint32_t sampleRate, const vector<Path>& paths) {
+    size_t result = 0;
+    for (const Path& path : paths) {
+        result = std::max(result, path.offset + getLatency(*path.pFilters));
+    }
+    for (const Path& path : paths) {
+        const size_t latency = path.offset + getLatency(*path.pFilters);
+        if (latency < result) {
+            // Delays are configured in milliseconds. FilterDelay rounds back to the same number of samples.
+            path.pFilters->push_back(std::make_unique<FilterDelay>(sampleRate, 1000.0 * (result - latency) / sampleRate));
+        }
+    }
+    return result;
+}
\ No newline at end of file
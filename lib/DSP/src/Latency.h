@@ -0,0 +1,26 @@
+/*
+    Time alignment of filter paths that are mixed together.
+    Faster paths get a delay so every path arrives with the latency of the slowest one.
+*/
+
+#pragma once
+#include "Filter.h"
+#include <memory>
+
+using std::unique_ptr;
+
+namespace Latency {
+
+    // Filters of one path, starting offset samples late. eg. a bus route behind the filters of its bus.
+    struct Path {
+        vector<unique_ptr<Filter>>* pFilters;
+        size_t offset;
+    };
+
+    // Sum of the latencies reported by the filters. Delays set by the user are not latency.
+    const size_t getLatency(const vector<unique_ptr<Filter>>& filters);
+
+    // Appends a delay to every path that is faster than the slowest one. Returns the latency of the slowest path.
+    const size_t align(const uint32_t sampleRate, const vector<Path>& paths);
+
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "MixingMatrix.h"
+#include "Error.h"
+
+MixingMatrix::MixingMatrix(const size_t numInputs, const size_t numOutputs) {
+    _numInputs = numInputs;
+    _numOutputs = numOutputs;
+    _gains = vector<double>(numInputs * numOutputs);
+    _terms = vector<vector<Term>>(numOutputs);
+}
+
+const size_t MixingMatrix::getNumInputs() const {
+    return _numInputs;
+}
+
+const size_t MixingMatrix::getNumOutputs() const {
+    return _numOutputs;
+}
+
+const double MixingMatrix::getGain(const size_t inputIndex, const size_t outputIndex) const {
+    return _gains[outputIndex * _numInputs + inputIndex];
+}
+
+void MixingMatrix::connect(const size_t inputIndex, const size_t outputIndex) {
+    vector<Term>& terms = _terms[outputIndex];
+    for (const Term& term : terms) {
+        if (term.inputIndex == inputIndex) {
+            return;
+        }
+    }
+    terms.push_back({ inputIndex, _gains[outputIndex * _numInputs + inputIndex] });
+}
+
+void MixingMatrix::setGain(const size_t inputIndex, const size_t outputIndex, const double gain) {
+    // Term lists never grow here. A reallocation would race with the processing thread.
+    for (Term& term : _terms[outputIndex]) {
+        if (term.inputIndex == inputIndex) {
+            _gains[outputIndex * _numInputs + inputIndex] = gain;
+            term.gain = gain;
+            return;
+        }
+    }
+    throw Error("Mixing matrix - Input %zu is not connected to output %zu", inputIndex, outputIndex);
+}
+
+const size_t MixingMatrix::getNumConnections() const {
+    size_t result = 0;
+    for (const vector<Term>& terms : _terms) {
+        result += terms.size();
+    }
+    return result;
+}
+
+void MixingMatrix::process(const double* const* const ppIn, double* const* const ppOut, const size_t numSamples) const {
+    for (size_t i = 0; i < _numOutputs; ++i) {
+        if (!_terms[i].empty()) {
+            processOutput(ppIn, ppOut[i], _terms[i], numSamples);
+        }
+    }
+}
+
+void MixingMatrix::processOutput(const double* const* const ppIn, double* const pOut, const vector<Term>& terms, const size_t numSamples) const {
+    const size_t tileSize = MIXING_MATRIX_TILE_SIZE * SIMD_WIDTH;
+    size_t offset = 0;
+    for (; offset + tileSize <= numSamples; offset += tileSize) {
+        Simd::Vec acc[MIXING_MATRIX_TILE_SIZE];
+        for (size_t j = 0; j < MIXING_MATRIX_TILE_SIZE; ++j) {
+            acc[j] = Simd::load(pOut + offset + j * SIMD_WIDTH);
+        }
+        for (const Term& term : terms) {
+            const Simd::Vec gain = Simd::set1(term.gain);
+            const double* const pIn = ppIn[term.inputIndex] + offset;
+            for (size_t j = 0; j < MIXING_MATRIX_TILE_SIZE; ++j) {
+                acc[j] = Simd::mulAdd(gain, Simd::load(pIn + j * SIMD_WIDTH), acc[j]);
+            }
+        }
+        for (size_t j = 0; j < MIXING_MATRIX_TILE_SIZE; ++j) {
+            Simd::store(pOut + offset + j * SIMD_WIDTH, acc[j]);
+        }
+    }
+    // Tail shorter than one tile.
+    for (; offset < numSamples; ++offset) {
+        double sum = pOut[offset];
+        for (const Term& term : terms) {
+            sum += term.gain * ppIn[term.inputIndex][offset];
+        }
+        pOut[offset] = sum;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+    Dense gain matrix that mixes a block of every input into a block of every output.
+    Outputs are accumulated a few SIMD vectors at a time in registers over all inputs with a gain,
+    so each output sample is loaded and stored once per block regardless of the number of inputs.
+*/
+
+#pragma once
+#include <vector>
+#include "Simd.h"
+
+using std::vector;
+
+// Number of SIMD vectors per output accumulated in registers.
+#define MIXING_MATRIX_TILE_SIZE 4
+
+class MixingMatrix {
+public:
+
+    MixingMatrix(const size_t numInputs, const size_t numOutputs);
+
+    const size_t getNumInputs() const;
+    const size_t getNumOutputs() const;
+    // Linear gain from input to output. 0 if not connected.
+    const double getGain(const size_t inputIndex, const size_t outputIndex) const;
+    // Adds the input to the output's term list at gain 0. Call for every pair that can get a gain before processing starts.
+    void connect(const size_t inputIndex, const size_t outputIndex);
+    // Changing the gain of a connected input only writes one value, so it can be done while another thread is
+    // processing, eg. for conditional routing. Throws if the input is not connected to the output.
+    void setGain(const size_t inputIndex, const size_t outputIndex, const double gain);
+    const size_t getNumConnections() const;
+
+    // ppIn and ppOut must contain one buffer per input and output. The result is added to the output buffers.
+    void process(const double* const* const ppIn, double* const* const ppOut, const size_t numSamples) const;
+
+private:
+    struct Term {
+        size_t inputIndex;
+        double gain;
+    };
+
+    // Output major, numOutputs * numInputs.
+    vector<double> _gains;
+    // Connected inputs per output.
+    vector<vector<Term>> _terms;
+    size_t _numInputs, _numOutputs;
+
+    void processOutput(const double* const* const ppIn, double* const pOut, const vector<Term>& terms, const size_t numSamples) const;
+
+};
\ No newline at end of file
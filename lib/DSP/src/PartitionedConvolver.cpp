@@ -0,0 +1,117 @@
+#include "PartitionedConvolver.h"
+#include <cstring>
+#include "Error.h"
+#include "FilterArena.h"
+
+PartitionedConvolver::PartitionedConvolver(const vector<double>& taps, const size_t partitionSize)
+    : _fft(2 * partitionSize) {
+    if (!taps.size()) {
+        throw Error("Partitioned convolution needs at least one tap");
+    }
+    _partitionSize = partitionSize;
+    _numBins = _fft.getNumBins();
+    _numPartitions = (taps.size() + partitionSize - 1) / partitionSize;
+
+    _filterSpectra = Simd::allocate<complex<double>>(_numPartitions * _numBins);
+    _delayLine = Simd::allocate<complex<double>>(_numPartitions * _numBins);
+    _accumulator = Simd::allocate<complex<double>>(_numBins);
+    _zeroPartitions = vector<bool>(_numPartitions);
+    _inputBuffer = Simd::allocate(2 * partitionSize);
+    _outputBuffer = Simd::allocate(partitionSize);
+    _timeBuffer = Simd::allocate(2 * partitionSize);
+
+    // Inverse transform is unscaled. Apply the scaling to the filter instead.
+    const double scale = 1.0 / _fft.getSize();
+    for (size_t p = 0; p < _numPartitions; ++p) {
+        const size_t start = p * partitionSize;
+        const size_t end = start + partitionSize < taps.size() ? start + partitionSize : taps.size();
+        bool isZero = true;
+        memset(_timeBuffer.get(), 0, 2 * partitionSize * sizeof(double));
+        for (size_t i = start; i < end; ++i) {
+            _timeBuffer[i - start] = taps[i] * scale;
+            if (taps[i] != 0.0) {
+                isZero = false;
+            }
+        }
+        _zeroPartitions[p] = isZero;
+        _fft.forward(_timeBuffer.get(), &_filterSpectra[p * _numBins]);
+    }
+
+    reset();
+}
+
+const size_t PartitionedConvolver::getPartitionSize() const {
+    return _partitionSize;
+}
+
+const size_t PartitionedConvolver::getNumPartitions() const {
+    return _numPartitions;
+}
+
+const size_t PartitionedConvolver::getLatency() const {
+    return _partitionSize;
+}
+
+void PartitionedConvolver::process(const double* const pIn, double* const pOut, const size_t numSamples) {
+    size_t offset = 0;
+    while (offset < numSamples) {
+        const size_t remaining = numSamples - offset;
+        const size_t available = _partitionSize - _bufferIndex;
+        const size_t count = remaining < available ? remaining : available;
+        // Read input before output is written since buffers can overlap.
+        memcpy(&_inputBuffer[_partitionSize + _bufferIndex], pIn + offset, count * sizeof(double));
+        memcpy(pOut + offset, &_outputBuffer[_bufferIndex], count * sizeof(double));
+        _bufferIndex += count;
+        offset += count;
+        if (_bufferIndex == _partitionSize) {
+            processPartition();
+            _bufferIndex = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::reset() {
+    memset((void*)_delayLine.get(), 0, _numPartitions * _numBins * sizeof(complex<double>));
+    memset(_inputBuffer.get(), 0, 2 * _partitionSize * sizeof(double));
+    memset(_outputBuffer.get(), 0, _partitionSize * sizeof(double));
+    _delayLineIndex = 0;
+    _bufferIndex = 0;
+}
+
+void PartitionedConvolver::relocate(FilterArena& arena) {
+    arena.relocate(_inputBuffer, 2 * _partitionSize);
+    arena.relocate(_delayLine, _numPartitions * _numBins);
+    arena.relocate(_filterSpectra, _numPartitions * _numBins);
+    arena.relocate(_accumulator, _numBins);
+    arena.relocate(_timeBuffer, 2 * _partitionSize);
+    arena.relocate(_outputBuffer, _partitionSize);
+}
+
+void PartitionedConvolver::processPartition() {
+    // Newest input spectrum goes into the current delay line slot.
+    _fft.forward(_inputBuffer.get(), &_delayLine[_delayLineIndex * _numBins]);
+
+    // Multiply accumulate every partition with the input spectrum of the same age.
+    double* const pAcc = reinterpret_cast<double*>(_accumulator.get());
+    memset(pAcc, 0, 2 * _numBins * sizeof(double));
+    for (size_t p = 0; p < _numPartitions; ++p) {
+        if (_zeroPartitions[p]) {
+            continue;
+        }
+        const size_t slot = (_delayLineIndex + _numPartitions - p) % _numPartitions;
+        const double* const pH = reinterpret_cast<const double*>(&_filterSpectra[p * _numBins]);
+        const double* const pX = reinterpret_cast<const double*>(&_delayLine[slot * _numBins]);
+        for (size_t k = 0; k < 2 * _numBins; k += 2) {
+            pAcc[k] += pH[k] * pX[k] - pH[k + 1] * pX[k + 1];
+            pAcc[k + 1] += pH[k] * pX[k + 1] + pH[k + 1] * pX[k];
+        }
+    }
+
+    // Overlap-save: the first half is circular aliasing, the second half is valid output.
+    _fft.inverse(_accumulator.get(), _timeBuffer.get());
+    memcpy(_outputBuffer.get(), &_timeBuffer[_partitionSize], _partitionSize * sizeof(double));
+
+    // Slide the input window one block.
+    memcpy(_inputBuffer.get(), &_inputBuffer[_partitionSize], _partitionSize * sizeof(double));
+    _delayLineIndex = (_delayLineIndex + 1) % _numPartitions;
+}
\ No newline at end of file
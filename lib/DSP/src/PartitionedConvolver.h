@@ -0,0 +1,40 @@
+/*
+    Uniformly partitioned overlap-save convolution.
+    The impulse response is split into partitions of partitionSize taps that are transformed once.
+    Transformed input blocks are kept in a frequency domain delay line, so each block only needs
+    one forward and one inverse FFT regardless of the number of taps.
+    Adds a latency of partitionSize samples.
+*/
+
+#pragma once
+#include "FFT.h"
+
+class FilterArena;
+
+class PartitionedConvolver {
+public:
+
+    PartitionedConvolver(const vector<double>& taps, const size_t partitionSize);
+
+    const size_t getPartitionSize() const;
+    const size_t getNumPartitions() const;
+    const size_t getLatency() const;
+
+    // pIn and pOut can point to the same buffer.
+    void process(const double* const pIn, double* const pOut, const size_t numSamples);
+    void reset();
+    void relocate(FilterArena& arena);
+
+private:
+    FFT _fft;
+    // Partition spectra and frequency domain delay line, numPartitions * numBins each.
+    Simd::AlignedBuffer<complex<double>> _filterSpectra, _delayLine, _accumulator;
+    // Partitions that are all zero are skipped.
+    vector<bool> _zeroPartitions;
+    // Sliding window of the last two input blocks.
+    Simd::AlignedBuffer<> _inputBuffer, _outputBuffer, _timeBuffer;
+    size_t _partitionSize, _numBins, _numPartitions, _delayLineIndex, _bufferIndex;
+
+    void processPartition();
+
+};
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "Resampler.h"
+#define _USE_MATH_DEFINES
+#include <math.h> // M_PI
+#include <cmath>
+#include <map>
+#include <utility> // pair
+#include <algorithm> // fill, min
+#include "Window.h"
+
+using std::map;
+using std::pair;
+using std::weak_ptr;
+
+// Passband and stopband edges relative to the lower of the two sample rates.
+#define RESAMPLER_PASSBAND 0.42
+#define RESAMPLER_STOPBAND 0.52
+#define RESAMPLER_ATTENUATION 100.0
+
+size_t greatestCommonDivisor(size_t a, size_t b) {
+    while (b) {
+        const size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+const bool Resampler::isSupported(const uint32_t inputRate, const uint32_t outputRate) {
+    if (!inputRate || !outputRate) {
+        return false;
+    }
+    return outputRate / greatestCommonDivisor(inputRate, outputRate) <= RESAMPLER_MAX_PHASES;
+}
+
+Resampler::Resampler(const uint32_t inputRate, const uint32_t outputRate, const size_t maxBlockSize) {
+    _maxBlockSize = maxBlockSize;
+    const size_t divisor = greatestCommonDivisor(inputRate, outputRate);
+    _up = outputRate / divisor;
+    _down = inputRate / divisor;
+    _tapsPerPhase = RESAMPLER_TAPS_PER_PHASE;
+    if (_down > _up) {
+        // Dot products take 2 * SIMD_WIDTH taps per step.
+        const size_t step = 2 * SIMD_WIDTH;
+        _tapsPerPhase = (RESAMPLER_TAPS_PER_PHASE * _down / _up + step - 1) / step * step;
+    }
+    _pBank = getFilterBank(inputRate, outputRate, _up, _down, _tapsPerPhase);
+    reset();
+}
+
+const size_t Resampler::getMaxOutputSize(const size_t numSamples) const {
+    return (numSamples * _up + _down - 1) / _down + 1;
+}
+
+const double Resampler::getLatency() const {
+    return (_tapsPerPhase * _up - 1) / (2.0 * _up);
+}
+
+void Resampler::reset() {
+    // Same size every time, so no allocation after construction.
+    _buffer.assign(_tapsPerPhase - 1 + _maxBlockSize, 0.0);
+    _time = 0;
+}
+
+const shared_ptr<const Resampler::FilterBank> Resampler::getFilterBank(const uint32_t inputRate, const uint32_t outputRate, const size_t up, const size_t down, const size_t tapsPerPhase) {
+    // Banks alive are reused. All channels of a stream use the same ratio.
+    static map<pair<size_t, size_t>, weak_ptr<const FilterBank>> banks;
+    const pair<size_t, size_t> key(up, down);
+    shared_ptr<const FilterBank> pBank = banks[key].lock();
+    if (pBank) {
+        return pBank;
+    }
+
+    // Windowed sinc prototype at up * inputRate. Cutoff between the passband and stopband of the lower rate.
+    const size_t length = up * tapsPerPhase;
+    const double lowRate = std::min(inputRate, outputRate);
+    const double cutoff = 0.5 * (RESAMPLER_PASSBAND + RESAMPLER_STOPBAND) * lowRate / ((double)up * inputRate);
+    const double beta = Window::kaiserBeta(RESAMPLER_ATTENUATION);
+    const double center = (length - 1) / 2.0;
+    vector<double> prototype(length);
+    double sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        const double x = i - center;
+        const double sinc = x == 0 ? 2 * cutoff : std::sin(2 * M_PI * cutoff * x) / (M_PI * x);
+        prototype[i] = sinc * Window::kaiser(x / center, beta);
+        sum += prototype[i];
+    }
+
+    // Split into phases. Unity gain per phase and reversed so taps line up with the oldest input sample first.
+    shared_ptr<FilterBank> pNewBank = std::make_shared<FilterBank>();
+    pNewBank->pTaps = Simd::allocate(length);
+    for (size_t phase = 0; phase < up; ++phase) {
+        double* const pRow = pNewBank->pTaps.get() + phase * tapsPerPhase;
+        for (size_t j = 0; j < tapsPerPhase; ++j) {
+            pRow[tapsPerPhase - 1 - j] = prototype[phase + j * up] * up / sum;
+        }
+    }
+    banks[key] = pNewBank;
+    return pNewBank;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+    Fixed ratio polyphase sample rate converter.
+    The ratio is reduced to up/down factors, eg. 44.1kHz to 48kHz is 160/147.
+    Each output sample is one dot product between a filter phase and the input history.
+    Filter banks are designed once per ratio and shared by all channels using the same ratio.
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstring> // memcpy, memmove
+#include <memory>
+#include <vector>
+#include "Simd.h"
+
+// Taps per filter phase when upsampling. Downsampling scales it by the ratio to keep the same transition band
+// relative to the output rate. Multiple of 2 * SIMD_WIDTH.
+#define RESAMPLER_TAPS_PER_PHASE 64
+// Max up factor after reduction. Limits the filter bank size.
+#define RESAMPLER_MAX_PHASES 1024
+
+using std::shared_ptr;
+using std::vector;
+
+class Resampler {
+public:
+
+    static const bool isSupported(const uint32_t inputRate, const uint32_t outputRate);
+
+    // maxBlockSize is the largest number of input samples per call to process(). The buffers are allocated up front.
+    Resampler(const uint32_t inputRate, const uint32_t outputRate, const size_t maxBlockSize);
+
+    // Exact number of samples the next call to process() produces for numSamples input samples.
+    inline const size_t getOutputSize(const size_t numSamples) const {
+        const size_t end = numSamples * _up;
+        return end > _time ? (end - _time + _down - 1) / _down : 0;
+    }
+
+    // Max number of output samples for numSamples input samples.
+    const size_t getMaxOutputSize(const size_t numSamples) const;
+    // Group delay in input samples.
+    const double getLatency() const;
+
+    // Returns number of samples written to pOut. numSamples must not exceed maxBlockSize.
+    inline const size_t process(const double* const pIn, const size_t numSamples, double* const pOut) {
+        const size_t historySize = _tapsPerPhase - 1;
+        double* const pBuffer = _buffer.data();
+        memcpy(pBuffer + historySize, pIn, numSamples * sizeof(double));
+        const double* const pTaps = _pBank->pTaps.get();
+        const size_t end = numSamples * _up;
+        size_t count = 0;
+        while (_time < end) {
+            // Window ends at the newest needed input sample.
+            const size_t index = _time / _up;
+            const size_t phase = _time - index * _up;
+            pOut[count++] = dotProduct(pTaps + phase * _tapsPerPhase, pBuffer + index);
+            _time += _down;
+        }
+        _time -= end;
+        memmove(pBuffer, pBuffer + numSamples, historySize * sizeof(double));
+        return count;
+    }
+
+    void reset();
+
+private:
+    struct FilterBank {
+        // One row of taps per phase, reversed to match the input order.
+        Simd::AlignedBuffer<> pTaps;
+    };
+
+    shared_ptr<const FilterBank> _pBank;
+    // Input history followed by the current block.
+    vector<double> _buffer;
+    size_t _up, _down, _time, _tapsPerPhase, _maxBlockSize;
+
+    static const shared_ptr<const FilterBank> getFilterBank(const uint32_t inputRate, const uint32_t outputRate, const size_t up, const size_t down, const size_t tapsPerPhase);
+
+    inline const double dotProduct(const double* const pTaps, const double* const pInput) const {
+        Simd::Vec sum1 = Simd::zero(), sum2 = Simd::zero();
+        for (size_t i = 0; i < _tapsPerPhase; i += 2 * SIMD_WIDTH) {
+            sum1 = Simd::mulAdd(Simd::loadAligned(pTaps + i), Simd::load(pInput + i), sum1);
+            sum2 = Simd::mulAdd(Simd::loadAligned(pTaps + i + SIMD_WIDTH), Simd::load(pInput + i + SIMD_WIDTH), sum2);
+        }
+        return Simd::sum(Simd::add(sum1, sum2));
+    }
+
+};
\ No newline at end of file
@@ -0,0 +1,181 @@
+/*
+    Thin wrappers around the SIMD intrinsics used by the vectorized filter kernels.
+    AVX(4 doubles per vector) is used when the compiler targets it, otherwise SSE2(2 doubles per vector).
+*/
+
+#pragma once
+#include <immintrin.h>
+#include <memory>
+#include <cstring>
+
+#if defined(__AVX__)
+#define SIMD_WIDTH 4
+#define SIMD_WIDTH_FLOAT 8
+#else
+#define SIMD_WIDTH 2
+#define SIMD_WIDTH_FLOAT 4
+#endif
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define SIMD_FMA
+#endif
+
+// Alignment in bytes of buffers from Simd::allocate. One cache line.
+#define SIMD_ALIGNMENT 64
+
+namespace Simd {
+
+#if defined(__AVX__)
+
+    typedef __m256d Vec;
+
+    inline Vec load(const double* const p) { return _mm256_loadu_pd(p); }
+    inline Vec loadAligned(const double* const p) { return _mm256_load_pd(p); }
+    inline void store(double* const p, const Vec v) { _mm256_storeu_pd(p, v); }
+    inline Vec set1(const double value) { return _mm256_set1_pd(value); }
+    inline Vec zero() { return _mm256_setzero_pd(); }
+    inline Vec add(const Vec a, const Vec b) { return _mm256_add_pd(a, b); }
+    inline Vec sub(const Vec a, const Vec b) { return _mm256_sub_pd(a, b); }
+    inline Vec mul(const Vec a, const Vec b) { return _mm256_mul_pd(a, b); }
+    // Repeating pattern a, b, a, b.
+    inline Vec setPairs(const double a, const double b) { return _mm256_set_pd(b, a, b, a); }
+    // Swap the elements of each pair. Real and imaginary part of interleaved complex values.
+    inline Vec swapPairs(const Vec v) { return _mm256_permute_pd(v, 0x5); }
+
+    // a * b + c
+    inline Vec mulAdd(const Vec a, const Vec b, const Vec c) {
+#ifdef SIMD_FMA
+        return _mm256_fmadd_pd(a, b, c);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+
+    // Sum of all elements in vector
+    inline double sum(const Vec v) {
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+
+    typedef __m256 VecFloat;
+
+    inline VecFloat load(const float* const p) { return _mm256_loadu_ps(p); }
+    inline VecFloat loadAligned(const float* const p) { return _mm256_load_ps(p); }
+    inline VecFloat zeroFloat() { return _mm256_setzero_ps(); }
+    inline VecFloat add(const VecFloat a, const VecFloat b) { return _mm256_add_ps(a, b); }
+
+    // a * b + c
+    inline VecFloat mulAdd(const VecFloat a, const VecFloat b, const VecFloat c) {
+#ifdef SIMD_FMA
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+    }
+
+    // Sum of all elements in vector
+    inline float sum(const VecFloat v) {
+        __m128 quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+        return _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 1)));
+    }
+
+#else
+
+    typedef __m128d Vec;
+
+    inline Vec load(const double* const p) { return _mm_loadu_pd(p); }
+    inline Vec loadAligned(const double* const p) { return _mm_load_pd(p); }
+    inline void store(double* const p, const Vec v) { _mm_storeu_pd(p, v); }
+    inline Vec set1(const double value) { return _mm_set1_pd(value); }
+    inline Vec zero() { return _mm_setzero_pd(); }
+    inline Vec add(const Vec a, const Vec b) { return _mm_add_pd(a, b); }
+    inline Vec sub(const Vec a, const Vec b) { return _mm_sub_pd(a, b); }
+    inline Vec mul(const Vec a, const Vec b) { return _mm_mul_pd(a, b); }
+    // Repeating pattern a, b.
+    inline Vec setPairs(const double a, const double b) { return _mm_set_pd(b, a); }
+    // Swap the elements of each pair. Real and imaginary part of interleaved complex values.
+    inline Vec swapPairs(const Vec v) { return _mm_shuffle_pd(v, v, 0x1); }
+
+    // a * b + c
+    inline Vec mulAdd(const Vec a, const Vec b, const Vec c) {
+#ifdef SIMD_FMA
+        return _mm_fmadd_pd(a, b, c);
+#else
+        return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+    }
+
+    // Sum of all elements in vector
+    inline double sum(const Vec v) {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+
+    typedef __m128 VecFloat;
+
+    inline VecFloat load(const float* const p) { return _mm_loadu_ps(p); }
+    inline VecFloat loadAligned(const float* const p) { return _mm_load_ps(p); }
+    inline VecFloat zeroFloat() { return _mm_setzero_ps(); }
+    inline VecFloat add(const VecFloat a, const VecFloat b) { return _mm_add_ps(a, b); }
+
+    // a * b + c
+    inline VecFloat mulAdd(const VecFloat a, const VecFloat b, const VecFloat c) {
+#ifdef SIMD_FMA
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    // Sum of all elements in vector
+    inline float sum(const VecFloat v) {
+        const __m128 pair = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+    }
+
+#endif
+
+    // Vector type and width for a sample type.
+    template<typename T> struct Traits;
+
+    template<> struct Traits<double> {
+        typedef Vec Vector;
+        static const size_t width = SIMD_WIDTH;
+        static inline Vector zero() { return Simd::zero(); }
+    };
+
+    template<> struct Traits<float> {
+        typedef VecFloat Vector;
+        static const size_t width = SIMD_WIDTH_FLOAT;
+        static inline Vector zero() { return zeroFloat(); }
+    };
+
+    struct AlignedDeleter {
+        // Buffers relocated into a FilterArena are freed with the arena.
+        bool isOwner;
+
+        AlignedDeleter(const bool isOwner = true) : isOwner(isOwner) {}
+
+        template<typename T>
+        void operator()(T* const p) const {
+            if (isOwner) {
+                _mm_free(p);
+            }
+        }
+    };
+
+    template<typename T = double>
+    using AlignedBuffer = std::unique_ptr<T[], AlignedDeleter>;
+
+    // Zero initialized buffer aligned to SIMD_ALIGNMENT bytes.
+    template<typename T = double>
+    inline AlignedBuffer<T> allocate(const size_t size) {
+        T* const p = (T*)_mm_malloc(size * sizeof(T), SIMD_ALIGNMENT);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        memset((void*)p, 0, size * sizeof(T));
+        return AlignedBuffer<T>(p);
+    }
+
+};
@@ -0,0 +1,40 @@
+/*
+    Window functions for FIR filter design.
+*/
+
+#pragma once
+#include <cmath>
+
+namespace Window {
+
+    // Zeroth order modified Bessel function of the first kind.
+    inline double besselI0(const double x) {
+        double sum = 1, term = 1;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+            if (term < sum * 1e-17) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    // Kaiser beta for a stopband attenuation in dB.
+    inline double kaiserBeta(const double attenuation) {
+        if (attenuation > 50) {
+            return 0.1102 * (attenuation - 8.7);
+        }
+        if (attenuation > 21) {
+            return 0.5842 * std::pow(attenuation - 21, 0.4) + 0.07886 * (attenuation - 21);
+        }
+        return 0;
+    }
+
+    // Kaiser window at position [-1, 1] relative to the window center.
+    inline double kaiser(const double position, const double beta) {
+        const double x = 1 - position * position;
+        return besselI0(beta * std::sqrt(x > 0 ? x : 0)) / besselI0(beta);
+    }
+
+};
\ No newline at end of file
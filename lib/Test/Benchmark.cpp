@@ -0,0 +1,375 @@
+#include "Benchmark.h"
+#include "DSP.h"
+#include "CrossoverType.h"
+#include "Resampler.h"
+#include "FFT.h"
+#include "ConvolutionMatrix.h"
+#include "MixingMatrix.h"
+#include "FilterArena.h"
+#include "Interleave.h"
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using std::vector;
+using std::unique_ptr;
+using std::make_unique;
+
+#define BENCHMARK_SAMPLE_RATE 48000
+#define BENCHMARK_BLOCK_SIZE 512
+
+// Seconds spent processing one block of audio.
+template<typename F>
+double timeBlock(F process) {
+    const auto start = std::chrono::steady_clock::now();
+    process();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Excite filter with noise, then time the tail in silence relative to the loud part.
+double measureTail(Filter& filter, const bool flushToZero, const bool useNoise) {
+    Denormal::setFlushToZero(flushToZero);
+    vector<double> block(BENCHMARK_BLOCK_SIZE);
+    uint32_t seed = 1, noiseSeed = 1;
+    double loudTime = 0, tailTime = 0;
+    const size_t numLoudBlocks = 100, numTailBlocks = 4000;
+    for (size_t i = 0; i < numLoudBlocks + numTailBlocks; ++i) {
+        for (double& sample : block) {
+            seed = seed * 1664525 + 1013904223;
+            sample = i < numLoudBlocks ? (int32_t)seed / 2147483648.0 : 0.0;
+        }
+        const double time = timeBlock([&] {
+            if (useNoise) {
+                Denormal::addNoise(block.data(), block.size(), noiseSeed);
+            }
+            filter.process(block.data(), block.data(), block.size());
+        });
+        if (i < numLoudBlocks) {
+            loudTime += time;
+        }
+        // Skip the first second of the tail. Denormals appear once the states have decayed.
+        else if (i >= numLoudBlocks + 100) {
+            tailTime += time;
+        }
+    }
+    Denormal::setFlushToZero(false);
+    return (tailTime / (numTailBlocks - 100)) / (loudTime / numLoudBlocks);
+}
+
+void benchmarkDenormal(const string& name, Filter& filter) {
+    const double none = measureTail(filter, false, false);
+    filter.reset();
+    const double ftz = measureTail(filter, true, false);
+    filter.reset();
+    const double noise = measureTail(filter, false, true);
+    filter.reset();
+    printf("%-24s tail/loud time: unprotected %6.2fx, FTZ/DAZ %6.2fx, noise %6.2fx\n", name.c_str(), none, ftz, noise);
+}
+
+void benchmarkDenormals() {
+    printf("Denormals: processing time of decaying tail relative to loud signal\n");
+    FilterBiquad lowPass(BENCHMARK_SAMPLE_RATE);
+    lowPass.addLowPass(80, CrossoverType::LINKWITZ_RILEY, 8);
+    benchmarkDenormal("Low pass LR8 80Hz", lowPass);
+
+    FilterBiquad peq(BENCHMARK_SAMPLE_RATE);
+    peq.addPEQ(30, 6, 5);
+    peq.addPEQ(45, -3, 3);
+    peq.addShelf(true, 100, 6, 0.707);
+    peq.compileStateSpace();
+    benchmarkDenormal("PEQ state space", peq);
+
+    FilterBiquad parallel(BENCHMARK_SAMPLE_RATE);
+    parallel.addHighPass(20, CrossoverType::BUTTERWORTH, 8);
+    parallel.compileParallel();
+    benchmarkDenormal("High pass BW8 parallel", parallel);
+
+    FilterCompression compression(BENCHMARK_SAMPLE_RATE, -30, 0.5, 5, 200, 1);
+    benchmarkDenormal("Compression", compression);
+    printf("\n");
+}
+
+// Percent of one core used to process the audio in real time.
+template<typename F>
+double measureLoad(const uint32_t sampleRate, F process) {
+    const size_t numBlocks = 2000;
+    double time = 0;
+    for (size_t i = 0; i < numBlocks; ++i) {
+        time += timeBlock(process);
+    }
+    return 100.0 * time * sampleRate / (numBlocks * BENCHMARK_BLOCK_SIZE);
+}
+
+void benchmarkResampler() {
+    const size_t numChannels = 8;
+    printf("Resampler: CPU load for %zu channels compared to a typical filter pipeline at the render sample rate\n", numChannels);
+    vector<double> input(BENCHMARK_BLOCK_SIZE), output(2 * BENCHMARK_BLOCK_SIZE + 2);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = sin(i * 0.01);
+    }
+    const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 96000 }, { 96000, 48000 } };
+    for (const auto& rate : rates) {
+        vector<Resampler> resamplers(numChannels, Resampler(rate[0], rate[1], BENCHMARK_BLOCK_SIZE));
+        const double resamplerLoad = measureLoad(rate[0], [&] {
+            for (Resampler& resampler : resamplers) {
+                resampler.process(input.data(), input.size(), output.data());
+            }
+        });
+
+        // Typical output: high pass crossover, room correction PEQ and a shelf.
+        vector<unique_ptr<FilterBiquad>> filters;
+        for (size_t i = 0; i < numChannels; ++i) {
+            filters.push_back(make_unique<FilterBiquad>(rate[1]));
+            filters.back()->addHighPass(80, CrossoverType::LINKWITZ_RILEY, 4);
+            filters.back()->addPEQ(50, -3, 4);
+            filters.back()->addShelf(true, 100, 3);
+            filters.back()->compileStateSpace();
+        }
+        const double filtersLoad = measureLoad(rate[1], [&] {
+            for (unique_ptr<FilterBiquad>& pFilter : filters) {
+                pFilter->process(input.data(), output.data(), input.size());
+            }
+        });
+
+        printf("%6dHz -> %6dHz: resampler %.2f%%, filters %.2f%%\n", rate[0], rate[1], resamplerLoad, filtersLoad);
+    }
+    printf("\n");
+}
+
+void benchmarkFFT() {
+    printf("FFT: time per transform. ns / (N log2 N) shows the scaling\n");
+    for (size_t size = 16; size <= (1 << 20); size *= 4) {
+        FFT fft(size);
+        vector<double> real(size);
+        vector<complex<double>> spectrum(size / 2 + 1), data(size);
+        for (size_t i = 0; i < size; ++i) {
+            real[i] = sin(i * 0.01);
+            data[i] = complex<double>(real[i], cos(i * 0.01));
+        }
+        // About the same amount of work for each size.
+        const size_t numRuns = std::max<size_t>(10, (1 << 24) / size);
+        const double realTime = timeBlock([&] {
+            for (size_t i = 0; i < numRuns; ++i) {
+                fft.forward(real.data(), spectrum.data());
+            }
+        }) / numRuns;
+        const double complexTime = timeBlock([&] {
+            for (size_t i = 0; i < numRuns; ++i) {
+                fft.forward(data.data(), data.data());
+            }
+        }) / numRuns;
+        const double scale = 1e9 / (size * log2((double)size));
+        printf("%8zu: real %10.2f us (%.2f ns), complex %10.2f us (%.2f ns)\n",
+            size, realTime * 1e6, realTime * scale, complexTime * 1e6, complexTime * scale);
+    }
+    printf("\n");
+}
+
+void benchmarkConvolutionMatrix() {
+    const size_t numTaps = 16384;
+    printf("Convolution matrix: CPU load for one input to several outputs, %zu taps per route\n", numTaps);
+    vector<double> input(BENCHMARK_BLOCK_SIZE), output(BENCHMARK_BLOCK_SIZE);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = sin(i * 0.01);
+    }
+    vector<double> taps(numTaps);
+    for (size_t i = 0; i < numTaps; ++i) {
+        taps[i] = exp(-(double)i / 1000) * cos(i * 0.1);
+    }
+    for (size_t numOutputs = 1; numOutputs <= 8; numOutputs *= 2) {
+        vector<unique_ptr<PartitionedConvolver>> convolvers;
+        vector<ConvolutionMatrix::Path> paths;
+        vector<vector<double>> outputs(numOutputs, vector<double>(BENCHMARK_BLOCK_SIZE));
+        vector<double*> pOutputs;
+        for (size_t i = 0; i < numOutputs; ++i) {
+            convolvers.push_back(make_unique<PartitionedConvolver>(taps, FIR_FFT_PARTITION_SIZE));
+            paths.push_back({ 0, i, taps });
+            pOutputs.push_back(outputs[i].data());
+        }
+        ConvolutionMatrix matrix(paths, FIR_FFT_PARTITION_SIZE);
+        const double* const pInput = input.data();
+
+        const double separateLoad = measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+            for (unique_ptr<PartitionedConvolver>& pConvolver : convolvers) {
+                pConvolver->process(input.data(), output.data(), input.size());
+            }
+        });
+        const double matrixLoad = measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+            matrix.process(&pInput, pOutputs.data(), input.size());
+        });
+        printf("%zu outputs: separate %.2f%%, matrix %.2f%%\n", numOutputs, separateLoad, matrixLoad);
+    }
+    printf("\n");
+}
+
+void benchmarkMixingMatrix() {
+    printf("Mixing matrix: CPU load for gain only routing, every input to every output\n");
+    for (size_t numChannels = 2; numChannels <= 32; numChannels *= 2) {
+        vector<vector<double>> inputs(numChannels, vector<double>(BENCHMARK_BLOCK_SIZE)), outputs(inputs);
+        vector<const double*> pInputs;
+        vector<double*> pOutputs;
+        for (size_t i = 0; i < numChannels; ++i) {
+            for (size_t j = 0; j < BENCHMARK_BLOCK_SIZE; ++j) {
+                inputs[i][j] = sin(j * 0.01 * (i + 1));
+            }
+            pInputs.push_back(inputs[i].data());
+            pOutputs.push_back(outputs[i].data());
+        }
+        MixingMatrix matrix(numChannels, numChannels);
+        for (size_t i = 0; i < numChannels; ++i) {
+            for (size_t j = 0; j < numChannels; ++j) {
+                matrix.setGain(i, j, 1.0 / numChannels);
+            }
+        }
+
+        // Same as a route with a gain filter: filter into a scratch buffer, then add to the output.
+        vector<double> buffer(BENCHMARK_BLOCK_SIZE);
+        FilterGain gain(-20 * log10((double)numChannels));
+        const double routesLoad = measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+            for (size_t i = 0; i < numChannels; ++i) {
+                for (size_t j = 0; j < numChannels; ++j) {
+                    gain.process(inputs[i].data(), buffer.data(), BENCHMARK_BLOCK_SIZE);
+                    for (size_t k = 0; k < BENCHMARK_BLOCK_SIZE; ++k) {
+                        outputs[j][k] += buffer[k];
+                    }
+                }
+            }
+        });
+        const double matrixLoad = measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+            matrix.process(pInputs.data(), pOutputs.data(), BENCHMARK_BLOCK_SIZE);
+        });
+        printf("%2zu x %2zu: routes %.3f%%, matrix %.3f%%\n", numChannels, numChannels, routesLoad, matrixLoad);
+    }
+    printf("\n");
+}
+
+void benchmarkFilterArena() {
+    printf("Filter arena: CPU load for outputs with gain, PEQs, delay and a short FIR, before and after relocation\n");
+    for (size_t numOutputs = 8; numOutputs <= 64; numOutputs *= 2) {
+        // Filters are created one output at a time with other allocations in between, like the config parser does.
+        vector<vector<unique_ptr<Filter>>> outputs(numOutputs);
+        vector<vector<double>> clutter;
+        for (size_t i = 0; i < numOutputs; ++i) {
+            vector<unique_ptr<Filter>>& filters = outputs[i];
+            filters.push_back(make_unique<FilterGain>(-3.0));
+            clutter.push_back(vector<double>(1000 + 100 * i));
+            unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(BENCHMARK_SAMPLE_RATE);
+            for (size_t j = 0; j < 6; ++j) {
+                pBiquad->addPEQ(100.0 * (j + 1) * (i + 1), -3, 2);
+            }
+            filters.push_back(move(pBiquad));
+            clutter.push_back(vector<double>(3000));
+            filters.push_back(make_unique<FilterDelay>(BENCHMARK_SAMPLE_RATE, 1.0 + i));
+            filters.push_back(make_unique<FilterFir>(vector<double>(128, 1.0 / 128)));
+        }
+        vector<vector<double>> inputs(numOutputs, vector<double>(BENCHMARK_BLOCK_SIZE)), buffers(inputs);
+        for (size_t i = 0; i < numOutputs; ++i) {
+            for (size_t j = 0; j < BENCHMARK_BLOCK_SIZE; ++j) {
+                inputs[i][j] = sin(j * 0.01 * (i + 1));
+            }
+        }
+        // Same input every block. Processing the output again would decay into denormals.
+        const auto processAll = [&] {
+            for (size_t i = 0; i < numOutputs; ++i) {
+                memcpy(buffers[i].data(), inputs[i].data(), BENCHMARK_BLOCK_SIZE * sizeof(double));
+                for (const unique_ptr<Filter>& pFilter : outputs[i]) {
+                    pFilter->process(buffers[i].data(), buffers[i].data(), BENCHMARK_BLOCK_SIZE);
+                }
+            }
+        };
+        const double heapLoad = measureLoad(BENCHMARK_SAMPLE_RATE, processAll);
+        FilterArena arena([&outputs](FilterArena& arena) {
+            for (vector<unique_ptr<Filter>>& filters : outputs) {
+                for (const unique_ptr<Filter>& pFilter : filters) {
+                    pFilter->relocate(arena);
+                }
+            }
+        });
+        const double arenaLoad = measureLoad(BENCHMARK_SAMPLE_RATE, processAll);
+        printf("%2zu outputs: heap %.3f%%, arena %.3f%%, %zu KB\n", numOutputs, heapLoad, arenaLoad, arena.getSize() / 1024);
+    }
+    printf("\n");
+}
+
+void benchmarkChannelLayouts() {
+    printf("Channel layouts: CPU load for a full block with deinterleave, mixing, 4 PEQs per output and interleave\n");
+    for (size_t numChannels = 16; numChannels <= 64; numChannels *= 2) {
+        vector<float> capture(numChannels * BENCHMARK_BLOCK_SIZE), render(capture.size());
+        for (size_t i = 0; i < capture.size(); ++i) {
+            capture[i] = (float)sin(i * 0.001);
+        }
+        vector<vector<double>> inputs(numChannels, vector<double>(BENCHMARK_BLOCK_SIZE)), outputs(inputs);
+        vector<const double*> pInputs;
+        vector<double*> pOutputs;
+        for (size_t i = 0; i < numChannels; ++i) {
+            pInputs.push_back(inputs[i].data());
+            pOutputs.push_back(outputs[i].data());
+        }
+        // Every input to its own output and mixed into the next one, like a bass or height downmix.
+        MixingMatrix matrix(numChannels, numChannels);
+        for (size_t i = 0; i < numChannels; ++i) {
+            matrix.setGain(i, i, 0.7);
+            matrix.setGain(i, (i + 1) % numChannels, 0.3);
+        }
+        vector<unique_ptr<FilterBiquad>> filters;
+        for (size_t i = 0; i < numChannels; ++i) {
+            filters.push_back(make_unique<FilterBiquad>(BENCHMARK_SAMPLE_RATE));
+            for (size_t j = 0; j < 4; ++j) {
+                filters.back()->addPEQ(50.0 * (j + 1) * (i + 1), -3, 2);
+            }
+        }
+        const double load = measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+            for (size_t i = 0; i < numChannels; ++i) {
+                const float* pCapture = capture.data() + i;
+                for (size_t j = 0; j < BENCHMARK_BLOCK_SIZE; ++j) {
+                    inputs[i][j] = *pCapture;
+                    pCapture += numChannels;
+                }
+                memset(outputs[i].data(), 0, BENCHMARK_BLOCK_SIZE * sizeof(double));
+            }
+            matrix.process(pInputs.data(), pOutputs.data(), BENCHMARK_BLOCK_SIZE);
+            for (size_t i = 0; i < numChannels; ++i) {
+                filters[i]->process(outputs[i].data(), outputs[i].data(), BENCHMARK_BLOCK_SIZE);
+                float* pRender = render.data() + i;
+                for (size_t j = 0; j < BENCHMARK_BLOCK_SIZE; ++j) {
+                    *pRender = (float)outputs[i][j];
+                    pRender += numChannels;
+                }
+            }
+        });
+        printf("%2zu channels: %.3f%%, %.4f%% per channel\n", numChannels, load, load / numChannels);
+    }
+    printf("\n");
+}
+
+void benchmarkInterleave() {
+    printf("Interleave: CPU load for deinterleaving the capture frames and interleaving the render frames of a block\n");
+    const size_t layouts[][2] = { { 2, 2 }, { 2, 4 }, { 6, 8 }, { 8, 8 }, { 12, 12 }, { 24, 24 } };
+    for (const auto& layout : layouts) {
+        const size_t numInputs = layout[0], numOutputs = layout[1];
+        vector<float> capture(numInputs * BENCHMARK_BLOCK_SIZE), render(numOutputs * BENCHMARK_BLOCK_SIZE);
+        for (size_t i = 0; i < capture.size(); ++i) {
+            capture[i] = (float)sin(i * 0.001);
+        }
+        vector<vector<double>> inputs(numInputs, vector<double>(BENCHMARK_BLOCK_SIZE)), outputs(numOutputs, vector<double>(BENCHMARK_BLOCK_SIZE));
+        vector<double*> pInputs, pOutputs;
+        for (vector<double>& block : inputs) {
+            pInputs.push_back(block.data());
+        }
+        for (vector<double>& block : outputs) {
+            pOutputs.push_back(block.data());
+        }
+        const auto measure = [&](const Interleave::Deinterleaver deinterleave, const Interleave::Interleaver interleave) {
+            return measureLoad(BENCHMARK_SAMPLE_RATE, [&] {
+                deinterleave(capture.data(), pInputs.data(), numInputs, BENCHMARK_BLOCK_SIZE);
+                interleave(pOutputs.data(), render.data(), numOutputs, BENCHMARK_BLOCK_SIZE);
+            });
+        };
+        const double genericLoad = measure(Interleave::deinterleave, Interleave::interleave);
+        const double load = measure(Interleave::getDeinterleaver(numInputs), Interleave::getInterleaver(numOutputs));
+        printf("%2zu -> %2zu: generic %.4f%%, selected %.4f%%\n", numInputs, numOutputs, genericLoad, load);
+    }
+    printf("\n");
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+/*
+    Performance benchmarks for the DSP library.
+    Results are printed to stdout. Run the test program with --benchmark.
+*/
+
+#pragma once
+
+// Slowdown of decaying filter tails with and without denormal protection.
+void benchmarkDenormals();
+
+// Resampler throughput compared to a typical output filter pipeline.
+void benchmarkResampler();
+
+// Real and complex FFT time for the supported sizes.
+void benchmarkFFT();
+
+// Batched convolution of one input to several outputs against one convolver per route.
+void benchmarkConvolutionMatrix();
+
+// Gain only routing through the mixing matrix against one accumulation loop per route.
+void benchmarkMixingMatrix();
+
+// Output filters processed from their scattered heap allocations against the same filters relocated into one arena.
+void benchmarkFilterArena();
+
+// Full block from interleaved capture to interleaved render at 16, 32 and 64 channels, eg. 7.1.4 and large interfaces.
+void benchmarkChannelLayouts();
+
+// Unrolled interleave of common layouts against the generic loop.
+void benchmarkInterleave();
\ No newline at end of file
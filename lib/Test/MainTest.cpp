@@ -9,6 +9,8 @@
 #include "File.h"
 #include "Audioclient.h" // WAVE_FORMAT_PCM, WAVE_FORMAT_IEEE_FLOAT
 #include "Error.h"
+#include "Benchmark.h"
+#include "Tests.h"
 
 using std::ofstream;
 using std::to_string;
@@ -358,7 +360,29 @@ void addCancellation(vector<GraphData*>& graphs) {
     graphs.push_back(graphData);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Benchmarks are slow and only run on request.
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        benchmarkDenormals();
+        benchmarkResampler();
+        benchmarkFFT();
+        benchmarkConvolutionMatrix();
+        benchmarkMixingMatrix();
+        benchmarkFilterArena();
+        benchmarkChannelLayouts();
+        benchmarkInterleave();
+        return 0;
+    }
+
+    // All tests run, also after a failure.
+    bool isOk = true;
+    for (const auto test : { testFilterOptimizer, testFFT, testConvolutionMatrix, testMixingMatrix, testFilterArena, testInterleave, testFirFft, testFirZeroLatency, testBiquadParallel, testBiquadStateSpace, testBiquadBank, testHalfBand, testResampler, testMinimumPhase, testFirTrim, testLinearPhase, testLatency }) {
+        isOk = test() && isOk;
+    }
+    if (!isOk) {
+        printf("TESTS FAILED\n\n");
+    }
+
     vector<GraphData*> graphs;
     addCrossover(graphs, true, 100, CrossoverType::BUTTERWORTH, { 1, 2, 3, 4, 5, 6, 7, 8 });
     addCrossover(graphs, false, 200, CrossoverType::BUTTERWORTH, { 1, 2, 3, 4, 5, 6, 7, 8 });
@@ -388,5 +412,5 @@ int main() {
     printMaxVal(pFilter);
     pFilter->printCoefficients(true);
 
-    return 0;
+    return isOk ? 0 : 1;
 }
\ No newline at end of file
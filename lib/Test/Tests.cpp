@@ -0,0 +1,791 @@
+#define _USE_MATH_DEFINES
+#include <math.h> // M_PI
+#include "Tests.h"
+#include "DSP.h"
+#include "CrossoverType.h"
+#include "FilterOptimizer.h"
+#include "FilterChain.h"
+#include "FFT.h"
+#include "ConvolutionMatrix.h"
+#include "MixingMatrix.h"
+#include "FilterArena.h"
+#include "Interleave.h"
+#include "BiquadBank.h"
+#include "Resampler.h"
+#include "Error.h"
+#include "Latency.h"
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <complex>
+
+using std::vector;
+using std::unique_ptr;
+using std::make_unique;
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_BLOCK_SIZE 512
+
+// Deterministic noise in [-0.5, 0.5).
+vector<double> createNoise(const size_t numSamples) {
+    vector<double> result(numSamples);
+    uint32_t seed = 1;
+    for (double& sample : result) {
+        seed = seed * 1664525 + 1013904223;
+        sample = (int32_t)seed / 4294967296.0;
+    }
+    return result;
+}
+
+// Decaying noise, like the tail of a measured filter.
+vector<double> createTaps(const size_t numTaps, const uint32_t seed) {
+    vector<double> result = createNoise(numTaps + seed);
+    result.erase(result.begin(), result.begin() + seed);
+    for (size_t i = 0; i < numTaps; ++i) {
+        result[i] *= exp(-(double)i / (numTaps / 8.0));
+    }
+    result[0] = 1;
+    return result;
+}
+
+vector<double> process(vector<unique_ptr<Filter>>& filters, const vector<double>& input) {
+    vector<double> output(input);
+    for (size_t i = 0; i < output.size(); i += TEST_BLOCK_SIZE) {
+        for (const unique_ptr<Filter>& pFilter : filters) {
+            pFilter->process(output.data() + i, output.data() + i, TEST_BLOCK_SIZE);
+        }
+    }
+    return output;
+}
+
+// Splits numSamples into blocks of varying size that don't line up with partitions, chunks or SIMD vectors.
+void forEachUnevenBlock(const size_t numSamples, std::function<void(const size_t offset, const size_t count)> callback) {
+    const size_t blockSizes[] = { 1, 7, 300, 64, 513, 129, 31 };
+    const size_t numBlockSizes = sizeof(blockSizes) / sizeof(blockSizes[0]);
+    for (size_t i = 0, offset = 0; offset < numSamples; ++i) {
+        const size_t count = std::min(blockSizes[i % numBlockSizes], numSamples - offset);
+        callback(offset, count);
+        offset += count;
+    }
+}
+
+vector<double> processUneven(Filter& filter, const vector<double>& input) {
+    vector<double> output(input.size());
+    forEachUnevenBlock(input.size(), [&](const size_t offset, const size_t count) {
+        filter.process(input.data() + offset, output.data() + offset, count);
+    });
+    return output;
+}
+
+// Max difference relative to the peak of expected, where both overlap. result is delayed by shift samples, ahead if negative.
+const double getErrorDb(const vector<double>& expected, const vector<double>& result, const ptrdiff_t shift = 0) {
+    double error = 0, level = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const ptrdiff_t index = (ptrdiff_t)i + shift;
+        if (index < 0 || index >= (ptrdiff_t)result.size()) {
+            continue;
+        }
+        error = std::max(error, std::abs(result[index] - expected[i]));
+        level = std::max(level, std::abs(expected[i]));
+    }
+    return 20 * log10(error / level + 1e-300);
+}
+
+const bool testFilterOptimizer(const string& name, std::function<vector<unique_ptr<Filter>>()> createFilters) {
+    vector<unique_ptr<Filter>> original = createFilters();
+    vector<unique_ptr<Filter>> optimized = createFilters();
+    FilterOptimizer::optimize(optimized);
+
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 200);
+    const vector<double> expected = process(original, input);
+    const vector<double> result = process(optimized, input);
+    // Merged FFT convolutions can have less latency.
+    const size_t shift = Latency::getLatency(original) - Latency::getLatency(optimized);
+    const double errorDb = getErrorDb(expected, result, -(ptrdiff_t)shift);
+    const bool isOk = errorDb < FILTER_ABSORB_ERROR_DB;
+    printf("%-36s %zd -> %zd filters, latency -%zd, max error %6.1f dB  %s\n",
+        name.c_str(), original.size(), optimized.size(), shift, errorDb, isOk ? "OK" : "FAILED");
+    return isOk;
+}
+
+const bool testFilterOptimizer() {
+    printf("Filter optimizer\n");
+    bool isAllOk = true;
+
+    isAllOk = testFilterOptimizer("Gain, biquad", [] {
+        vector<unique_ptr<Filter>> filters;
+        filters.push_back(make_unique<FilterGain>(-6.0, true));
+        unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pBiquad->addCrossover(false, 80, CrossoverType::LINKWITZ_RILEY, 4);
+        pBiquad->compileStateSpace();
+        filters.push_back(move(pBiquad));
+        return filters;
+    }) && isAllOk;
+
+    isAllOk = testFilterOptimizer("Gain, FIR, FIR, biquad", [] {
+        vector<unique_ptr<Filter>> filters;
+        filters.push_back(make_unique<FilterGain>(-3.0));
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 1)));
+        filters.push_back(make_unique<FilterFir>(createTaps(4000, 2), FIR_FFT_PARTITION_SIZE));
+        unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pBiquad->addPEQ(5000, -4, 2);
+        pBiquad->addPEQ(8000, 3, 4);
+        filters.push_back(move(pBiquad));
+        return filters;
+    }) && isAllOk;
+
+    isAllOk = testFilterOptimizer("FIR, delay, FIR, compression, gain", [] {
+        vector<unique_ptr<Filter>> filters;
+        filters.push_back(make_unique<FilterFir>(createTaps(2000, 3), FIR_FFT_PARTITION_SIZE));
+        filters.push_back(make_unique<FilterDelay>(TEST_SAMPLE_RATE, 2.0));
+        filters.push_back(make_unique<FilterFir>(createTaps(3000, 4), 512));
+        filters.push_back(make_unique<FilterCompression>(TEST_SAMPLE_RATE, -20.0, 0.25, 5.0, 50.0, 0.0));
+        filters.push_back(make_unique<FilterGain>(3.0));
+        unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pBiquad->addCrossover(true, 100, CrossoverType::BUTTERWORTH, 5);
+        pBiquad->compileParallel();
+        filters.push_back(move(pBiquad));
+        return filters;
+    }) && isAllOk;
+
+    // Compression wrapped in another filter still splits the list.
+    isAllOk = testFilterOptimizer("FIR, multirate compression, FIR", [] {
+        vector<unique_ptr<Filter>> filters, inner;
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 5)));
+        inner.push_back(make_unique<FilterCompression>(TEST_SAMPLE_RATE / 4, -20.0, 0.25, 5.0, 50.0, 0.0));
+        filters.push_back(make_unique<FilterMultirate>(TEST_SAMPLE_RATE, 4, inner));
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 6)));
+        return filters;
+    }) && isAllOk;
+
+    isAllOk = testFilterOptimizer("FIR, chained compression, FIR", [] {
+        vector<unique_ptr<Filter>> filters, inner;
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 7)));
+        unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pBiquad->addPEQ(1000, 6, 1);
+        inner.push_back(move(pBiquad));
+        inner.push_back(make_unique<FilterCompression>(TEST_SAMPLE_RATE, -20.0, 0.25, 5.0, 50.0, 0.0));
+        filters.push_back(FilterChain<FilterBiquad, FilterCompression>::tryCreate(inner));
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 8)));
+        return filters;
+    }) && isAllOk;
+
+    printf("\n");
+    return isAllOk;
+}
+
+const bool testFFT() {
+    printf("FFT\n");
+    bool isAllOk = true;
+    for (size_t size = 4; size <= (1 << 20); size *= 2) {
+        FFT fft(size);
+        const vector<double> input = createNoise(size);
+        vector<complex<double>> data(size), spectrum(size / 2 + 1), result(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = complex<double>(input[i], input[size - 1 - i]);
+        }
+        fft.forward(input.data(), spectrum.data());
+        fft.forward(data.data(), result.data());
+
+        // Naive DFT is O(N^2). Only the smaller sizes.
+        double realError = 0, complexError = 0;
+        if (size <= 4096) {
+            for (size_t k = 0; k < size; ++k) {
+                complex<double> realSum = 0, complexSum = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    const complex<double> w = std::polar(1.0, -2 * M_PI * ((i * k) % size) / size);
+                    realSum += input[i] * w;
+                    complexSum += data[i] * w;
+                }
+                if (k < spectrum.size()) {
+                    realError = std::max(realError, std::abs(spectrum[k] - realSum));
+                }
+                complexError = std::max(complexError, std::abs(result[k] - complexSum));
+            }
+        }
+
+        // Round trip. In place for the complex transform.
+        vector<double> realInverse(size);
+        fft.inverse(spectrum.data(), realInverse.data());
+        fft.inverse(result.data(), result.data());
+        double roundTripError = 0;
+        for (size_t i = 0; i < size; ++i) {
+            roundTripError = std::max(roundTripError, std::abs(realInverse[i] / size - input[i]));
+            roundTripError = std::max(roundTripError, std::abs(result[i] / (double)size - data[i]));
+        }
+
+        // Error relative to the expected rms level of the bins.
+        const double level = sqrt(size / 12.0);
+        const bool isOk = realError / level < 1e-12 && complexError / level < 1e-12 && roundTripError < 1e-13;
+        printf("%8zu: DFT error real %.1e, complex %.1e, round trip %.1e  %s\n",
+            size, realError / level, complexError / level, roundTripError, isOk ? "OK" : "FAILED");
+        isAllOk = isAllOk && isOk;
+    }
+    printf("\n");
+    return isAllOk;
+}
+
+const bool testConvolutionMatrix() {
+    printf("Convolution matrix\n");
+    const size_t numInputs = 3, numOutputs = 4;
+    // One input to three outputs like a sub array, two inputs to one output and a partial partition.
+    const size_t routes[][3] = { { 0, 0, 3000 }, { 0, 1, 2048 }, { 0, 2, 700 }, { 1, 3, 1500 }, { 2, 3, 4000 } };
+    vector<ConvolutionMatrix::Path> paths;
+    vector<unique_ptr<PartitionedConvolver>> convolvers;
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); ++i) {
+        paths.push_back({ routes[i][0], routes[i][1], createTaps(routes[i][2], (uint32_t)i + 1) });
+        convolvers.push_back(make_unique<PartitionedConvolver>(paths.back().taps, FIR_FFT_PARTITION_SIZE));
+    }
+    ConvolutionMatrix matrix(paths, FIR_FFT_PARTITION_SIZE);
+
+    const size_t numSamples = TEST_BLOCK_SIZE * 100;
+    vector<vector<double>> inputs, expected(numOutputs, vector<double>(numSamples)), result(numOutputs, vector<double>(numSamples));
+    for (size_t i = 0; i < numInputs; ++i) {
+        inputs.push_back(createNoise(numSamples + i));
+        inputs.back().erase(inputs.back().begin(), inputs.back().begin() + i);
+    }
+    vector<double> buffer(numSamples);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        convolvers[i]->process(inputs[paths[i].inputIndex].data(), buffer.data(), numSamples);
+        for (size_t j = 0; j < numSamples; ++j) {
+            expected[paths[i].outputIndex][j] += buffer[j];
+        }
+    }
+    // Blocks that are not a multiple of the partition size.
+    const size_t blockSize = 300;
+    vector<const double*> pIn(numInputs);
+    vector<double*> pOut(numOutputs);
+    for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+        for (size_t i = 0; i < numInputs; ++i) {
+            pIn[i] = inputs[i].data() + offset;
+        }
+        for (size_t i = 0; i < numOutputs; ++i) {
+            pOut[i] = result[i].data() + offset;
+        }
+        matrix.process(pIn.data(), pOut.data(), std::min(blockSize, numSamples - offset));
+    }
+
+    double errorDb = -INFINITY;
+    for (size_t i = 0; i < numOutputs; ++i) {
+        errorDb = std::max(errorDb, getErrorDb(expected[i], result[i]));
+    }
+    const bool isOk = errorDb < -200;
+    printf("%zu paths, %zu inputs, %zu outputs, max error %6.1f dB  %s\n",
+        matrix.getNumPaths(), matrix.getNumInputs(), matrix.getNumOutputs(), errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testMixingMatrix() {
+    printf("Mixing matrix\n");
+    const size_t numInputs = 8, numOutputs = 6;
+    MixingMatrix matrix(numInputs, numOutputs);
+    for (size_t i = 0; i < numInputs; ++i) {
+        for (size_t j = 0; j < numOutputs; ++j) {
+            if ((i + j) % 3) {
+                matrix.connect(i, j);
+                matrix.setGain(i, j, 0.1 * (i + 1) - 0.05 * j);
+            }
+        }
+    }
+    // Disconnected by gain 0 after being connected, as conditional routing does.
+    matrix.setGain(1, 1, 0.0);
+    // Connected at gain 0, like routes that cancel, and given a gain later.
+    matrix.connect(0, 3);
+    matrix.setGain(0, 3, 0.5);
+    // Gains of unconnected pairs can't be set.
+    bool isThrown = false;
+    try {
+        matrix.setGain(0, 0, 1.0);
+    }
+    catch (const Error&) {
+        isThrown = true;
+    }
+
+    // Not a multiple of the SIMD tile size.
+    const size_t numSamples = TEST_BLOCK_SIZE - 3;
+    vector<vector<double>> inputs;
+    for (size_t i = 0; i < numInputs; ++i) {
+        inputs.push_back(createNoise(numSamples + i));
+        inputs.back().erase(inputs.back().begin(), inputs.back().begin() + i);
+    }
+    vector<vector<double>> expected(numOutputs, createNoise(numSamples)), result(expected);
+    for (size_t j = 0; j < numOutputs; ++j) {
+        for (size_t i = 0; i < numInputs; ++i) {
+            const double gain = matrix.getGain(i, j);
+            for (size_t k = 0; k < numSamples; ++k) {
+                expected[j][k] += gain * inputs[i][k];
+            }
+        }
+    }
+    vector<const double*> pIn;
+    vector<double*> pOut;
+    for (size_t i = 0; i < numInputs; ++i) {
+        pIn.push_back(inputs[i].data());
+    }
+    for (size_t j = 0; j < numOutputs; ++j) {
+        pOut.push_back(result[j].data());
+    }
+    matrix.process(pIn.data(), pOut.data(), numSamples);
+
+    double error = 0;
+    for (size_t j = 0; j < numOutputs; ++j) {
+        for (size_t k = 0; k < numSamples; ++k) {
+            error = std::max(error, std::abs(result[j][k] - expected[j][k]));
+        }
+    }
+    const bool isOk = error < 1e-14 && isThrown && matrix.getGain(0, 0) == 0;
+    printf("%zu inputs, %zu outputs, %zu connections, max error %.1e  %s\n",
+        numInputs, numOutputs, matrix.getNumConnections(), error, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testFilterArena() {
+    printf("Filter arena\n");
+    std::function<vector<unique_ptr<Filter>>()> createFilters = [] {
+        vector<unique_ptr<Filter>> filters;
+        filters.push_back(make_unique<FilterGain>(-3.0));
+        unique_ptr<FilterBiquad> pCascade = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pCascade->addPEQ(5000, -4, 2);
+        pCascade->addHighShelf(8000, 3);
+        filters.push_back(move(pCascade));
+        unique_ptr<FilterBiquad> pStateSpace = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pStateSpace->addCrossover(false, 80, CrossoverType::LINKWITZ_RILEY, 4);
+        pStateSpace->compileStateSpace();
+        filters.push_back(move(pStateSpace));
+        unique_ptr<FilterBiquad> pParallel = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pParallel->addCrossover(true, 100, CrossoverType::BUTTERWORTH, 5);
+        pParallel->compileParallel();
+        filters.push_back(move(pParallel));
+        filters.push_back(make_unique<FilterDelay>(TEST_SAMPLE_RATE, 2.0));
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 1)));
+        filters.push_back(make_unique<FilterFir>(createTaps(300, 2), 0, true));
+        filters.push_back(make_unique<FilterFir>(createTaps(3000, 3), FIR_FFT_PARTITION_SIZE));
+        filters.push_back(make_unique<FilterFirZeroLatency>(createTaps(2000, 4)));
+        filters.push_back(make_unique<FilterCancellation>(TEST_SAMPLE_RATE, 40.0, -6.0));
+        return filters;
+    };
+    vector<unique_ptr<Filter>> original = createFilters();
+    vector<unique_ptr<Filter>> relocated = createFilters();
+
+    // Relocate half way so that the filter states have to be carried over.
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 100);
+    const size_t half = input.size() / 2;
+    const vector<double> expected = process(original, input);
+    vector<double> result = process(relocated, vector<double>(input.begin(), input.begin() + half));
+    FilterArena arena([&relocated](FilterArena& arena) {
+        for (const unique_ptr<Filter>& pFilter : relocated) {
+            pFilter->relocate(arena);
+        }
+    });
+    const vector<double> secondHalf = process(relocated, vector<double>(input.begin() + half, input.end()));
+    result.insert(result.end(), secondHalf.begin(), secondHalf.end());
+
+    double error = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        error = std::max(error, std::abs(result[i] - expected[i]));
+    }
+    const bool isOk = error == 0;
+    printf("%zu filters, %zu buffers, %zu KB, max error %.1e  %s\n",
+        relocated.size(), arena.getNumBuffers(), arena.getSize() / 1024, error, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testInterleave() {
+    printf("Interleave\n");
+    const size_t numSamples = TEST_BLOCK_SIZE - 3;
+    size_t numLayouts = 0, numSpecialized = 0, numErrors = 0;
+    for (size_t numChannels = 1; numChannels <= 24; ++numChannels) {
+        const vector<double> noise = createNoise(numChannels * numSamples);
+        vector<float> frames(noise.begin(), noise.end()), result(frames.size());
+        vector<vector<double>> blocks(numChannels, vector<double>(numSamples));
+        vector<double*> pBlocks;
+        for (vector<double>& block : blocks) {
+            pBlocks.push_back(block.data());
+        }
+        Interleave::getDeinterleaver(numChannels)(frames.data(), pBlocks.data(), numChannels, numSamples);
+        for (size_t i = 0; i < numChannels; ++i) {
+            for (size_t j = 0; j < numSamples; ++j) {
+                numErrors += blocks[i][j] != frames[j * numChannels + i];
+            }
+        }
+        // Float to double and back is exact.
+        Interleave::getInterleaver(numChannels)(pBlocks.data(), result.data(), numChannels, numSamples);
+        numErrors += result != frames;
+        numSpecialized += Interleave::isSpecialized(numChannels);
+        ++numLayouts;
+    }
+    const bool isOk = numErrors == 0;
+    printf("%zu layouts, %zu unrolled, %zu errors  %s\n", numLayouts, numSpecialized, numErrors, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testFirFft() {
+    printf("FIR FFT convolution\n");
+    const vector<double> taps = createTaps(3000, 9);
+    FilterFir direct(taps);
+    FilterFir fft(taps, FIR_FFT_PARTITION_SIZE);
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 100);
+    const vector<double> expected = processUneven(direct, input);
+    const vector<double> result = processUneven(fft, input);
+    // FFT convolution is delayed by one partition.
+    const size_t shift = fft.getLatency() - direct.getLatency();
+    const double errorDb = getErrorDb(expected, result, (ptrdiff_t)shift);
+    const bool isOk = shift == FIR_FFT_PARTITION_SIZE && errorDb < -280;
+    printf("%zu taps, latency %zu, max error %6.1f dB  %s\n", taps.size(), shift, errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testFirZeroLatency() {
+    printf("FIR zero latency\n");
+    // Long enough to use segments of every partition size.
+    const vector<double> taps = createTaps(20000, 10);
+    FilterFir direct(taps);
+    FilterFirZeroLatency zeroLatency(taps);
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 100);
+    const vector<double> expected = processUneven(direct, input);
+    const vector<double> result = processUneven(zeroLatency, input);
+    const double errorDb = getErrorDb(expected, result);
+    const bool isOk = zeroLatency.getLatency() == 0 && errorDb < -200;
+    printf("%zu taps, latency %zu, max error %6.1f dB  %s\n", taps.size(), zeroLatency.getLatency(), errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+// High pass and room correction PEQs, like a typical output.
+unique_ptr<FilterBiquad> createBiquadCascade() {
+    unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+    pBiquad->addCrossover(false, 80, CrossoverType::LINKWITZ_RILEY, 4);
+    const double frequencies[] = { 45, 110, 250, 600, 1400, 3000, 7000, 12000 };
+    for (size_t i = 0; i < 8; ++i) {
+        pBiquad->addPEQ(frequencies[i], i % 2 ? 4.0 : -6.0, 1 + i * 0.5);
+    }
+    return pBiquad;
+}
+
+const bool testBiquadParallel() {
+    printf("Biquad parallel sections\n");
+    unique_ptr<FilterBiquad> pCascade = createBiquadCascade();
+    unique_ptr<FilterBiquad> pParallel = createBiquadCascade();
+    const bool isParallel = pParallel->compileParallel();
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 100);
+    const vector<double> expected = processUneven(*pCascade, input);
+    const vector<double> result = processUneven(*pParallel, input);
+    const double errorDb = getErrorDb(expected, result);
+    const bool isOk = isParallel && errorDb < -200;
+    printf("%zu sections, parallel %s, max error %6.1f dB  %s\n", pParallel->size(), isParallel ? "yes" : "no", errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testBiquadStateSpace() {
+    printf("Biquad state space\n");
+    unique_ptr<FilterBiquad> pCascade = createBiquadCascade();
+    unique_ptr<FilterBiquad> pStateSpace = createBiquadCascade();
+    pStateSpace->compileStateSpace();
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 100);
+    const vector<double> expected = processUneven(*pCascade, input);
+    // Uneven blocks mix whole state space blocks with partial blocks on the shared state.
+    const vector<double> result = processUneven(*pStateSpace, input);
+    const double errorDb = getErrorDb(expected, result);
+    const bool isOk = errorDb < -200;
+    printf("%zu sections, max error %6.1f dB  %s\n", pStateSpace->size(), errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testBiquadBank() {
+    printf("Biquad bank\n");
+    // More lanes than one SIMD group, so the last group is partly used.
+    const size_t numLanes = SIMD_WIDTH + 1;
+    vector<unique_ptr<FilterBiquad>> filters;
+    vector<const FilterBiquad*> bankFilters;
+    vector<vector<double>> expected, result;
+    for (size_t lane = 0; lane < numLanes; ++lane) {
+        unique_ptr<FilterBiquad> pBiquad = make_unique<FilterBiquad>(TEST_SAMPLE_RATE);
+        pBiquad->addCrossover(lane % 2 == 0, 100.0 + lane * 50, CrossoverType::BUTTERWORTH, 4);
+        pBiquad->addPEQ(1000.0 + lane * 300, lane % 2 ? 3.0 : -5.0, 2);
+        bankFilters.push_back(pBiquad.get());
+        vector<double> input = createNoise(TEST_BLOCK_SIZE * 100 + lane);
+        input.erase(input.begin(), input.begin() + lane);
+        result.push_back(input);
+        expected.push_back(processUneven(*pBiquad, input));
+        filters.push_back(move(pBiquad));
+    }
+    BiquadBank bank(bankFilters);
+    vector<double*> pointers(numLanes);
+    forEachUnevenBlock(result[0].size(), [&](const size_t offset, const size_t count) {
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            pointers[lane] = result[lane].data() + offset;
+        }
+        bank.process(pointers.data(), count);
+    });
+    double errorDb = -INFINITY;
+    for (size_t lane = 0; lane < numLanes; ++lane) {
+        errorDb = std::max(errorDb, getErrorDb(expected[lane], result[lane]));
+    }
+    const bool isOk = errorDb < -200;
+    printf("%zu lanes, %zu sections, max error %6.1f dB  %s\n", numLanes, bank.getNumSections(), errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+// Peak level in dB of a sine processed by filter, measured after the filter has settled.
+const double getSineLevelDb(Filter& filter, const double frequency) {
+    vector<double> input(TEST_SAMPLE_RATE);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = sin(2 * M_PI * frequency * i / TEST_SAMPLE_RATE);
+    }
+    filter.reset();
+    const vector<double> output = processUneven(filter, input);
+    double sum = 0;
+    for (size_t i = output.size() / 2; i < output.size(); ++i) {
+        sum += output[i] * output[i];
+    }
+    return 10 * log10(2 * sum / (output.size() / 2) + 1e-300);
+}
+
+const bool testHalfBand() {
+    printf("Half-band decimation\n");
+    vector<unique_ptr<Filter>> filters;
+    FilterMultirate multirate(TEST_SAMPLE_RATE, 8, filters);
+    // Passband of the reduced rate is 1200Hz.
+    const double passbandDb = getSineLevelDb(multirate, 500);
+    // Each of these aliases into the passband of the reduced rate.
+    double stopbandDb = -INFINITY;
+    for (const double frequency : { 5000.0, 6500.0, 11500.0, 13000.0, 18500.0, 23000.0 }) {
+        stopbandDb = std::max(stopbandDb, getSineLevelDb(multirate, frequency));
+    }
+    const bool isOk = std::abs(passbandDb) < 0.001 && stopbandDb < -HALF_BAND_ATTENUATION;
+    printf("1/%zu rate, passband %.4f dB, max alias %6.1f dB  %s\n", multirate.getFactor(), passbandDb, stopbandDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+// Resampled sine in blocks of uneven size.
+vector<double> resample(const uint32_t inputRate, const uint32_t outputRate, const double frequency) {
+    vector<double> input(inputRate);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = sin(2 * M_PI * frequency * i / inputRate);
+    }
+    Resampler resampler(inputRate, outputRate, input.size());
+    vector<double> output(resampler.getMaxOutputSize(input.size()));
+    size_t numOutput = 0;
+    forEachUnevenBlock(input.size(), [&](const size_t offset, const size_t count) {
+        numOutput += resampler.process(input.data() + offset, count, output.data() + numOutput);
+    });
+    output.resize(numOutput);
+    return output;
+}
+
+const bool testResampler() {
+    printf("Resampler\n");
+    bool isAllOk = true;
+    const uint32_t rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 96000, 48000 } };
+    for (const auto& rate : rates) {
+        const uint32_t inputRate = rate[0], outputRate = rate[1];
+        const double latency = Resampler(inputRate, outputRate, 1).getLatency() / inputRate;
+        // SNR against the ideal sine at the output rate, over the second half of a second.
+        double snrDb = INFINITY;
+        for (const double frequency : { 1000.0, 10000.0, 17000.0 }) {
+            const vector<double> output = resample(inputRate, outputRate, frequency);
+            double signal = 0, noise = 0;
+            for (size_t i = output.size() / 2; i < output.size(); ++i) {
+                const double expected = sin(2 * M_PI * frequency * ((double)i / outputRate - latency));
+                signal += expected * expected;
+                noise += (output[i] - expected) * (output[i] - expected);
+            }
+            snrDb = std::min(snrDb, 10 * log10(signal / (noise + 1e-300)));
+        }
+        // Content above the lower Nyquist frequency must not alias into the output.
+        double aliasDb = -INFINITY;
+        if (outputRate < inputRate) {
+            const vector<double> output = resample(inputRate, outputRate, 0.55 * outputRate);
+            double sum = 0;
+            for (size_t i = output.size() / 2; i < output.size(); ++i) {
+                sum += output[i] * output[i];
+            }
+            aliasDb = 10 * log10(2 * sum / (output.size() - output.size() / 2) + 1e-300);
+        }
+        const bool isOk = snrDb > 100 && aliasDb < -95;
+        printf("%u -> %u, min SNR %6.1f dB, alias %6.1f dB  %s\n", inputRate, outputRate, snrDb, aliasDb, isOk ? "OK" : "FAILED");
+        isAllOk = isAllOk && isOk;
+    }
+    printf("\n");
+    return isAllOk;
+}
+
+// Magnitude in dB relative to the peak of each bin of a zero padded FFT.
+vector<double> getMagnitudeDb(const vector<double>& taps, const size_t fftSize) {
+    FFT fft(fftSize);
+    vector<double> buffer(fftSize);
+    vector<std::complex<double>> spectrum(fft.getNumBins());
+    std::copy(taps.begin(), taps.end(), buffer.begin());
+    fft.forward(buffer.data(), spectrum.data());
+    vector<double> result(spectrum.size());
+    for (size_t i = 0; i < spectrum.size(); ++i) {
+        result[i] = 20 * log10(std::abs(spectrum[i]) + 1e-300);
+    }
+    return result;
+}
+
+const bool testMinimumPhase() {
+    printf("Minimum phase FIR\n");
+    FilterBiquad biquad(TEST_SAMPLE_RATE);
+    biquad.addCrossover(true, 80, CrossoverType::LINKWITZ_RILEY, 4);
+    const vector<double> linear = FirDesign::linearPhase(biquad.getBiquads(), LINEAR_PHASE_TAPS);
+    const vector<double> minimum = FirDesign::minimumPhase(linear);
+    size_t peakIndex = 0;
+    for (size_t i = 0; i < minimum.size(); ++i) {
+        if (std::abs(minimum[i]) > std::abs(minimum[peakIndex])) {
+            peakIndex = i;
+        }
+    }
+    // Compared down to -60 dB. Below that the difference is irrelevant.
+    const size_t fftSize = 65536;
+    const vector<double> expected = getMagnitudeDb(linear, fftSize);
+    const vector<double> result = getMagnitudeDb(minimum, fftSize);
+    double errorDb = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i] > -60) {
+            errorDb = std::max(errorDb, std::abs(result[i] - expected[i]));
+        }
+    }
+    // The linear phase peak is at the center. A low pass has its minimum phase peak after its group delay.
+    const bool isOk = minimum.size() < linear.size() && peakIndex < linear.size() / 16 && errorDb < 0.01;
+    printf("%zu -> %zu taps, peak at tap %zu, max magnitude error %.4f dB  %s\n", linear.size(), minimum.size(), peakIndex, errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testFirTrim() {
+    printf("FIR trim\n");
+    // Measured FIRs often have a quiet lead in and a long noise floor.
+    const size_t numLeading = 700, numTrailing = 3000;
+    vector<double> taps = createNoise(numLeading);
+    for (double& tap : taps) {
+        tap *= 1e-9;
+    }
+    const vector<double> body = createTaps(4000, 11);
+    taps.insert(taps.end(), body.begin(), body.end());
+    const vector<double> tail = createNoise(numTrailing);
+    for (const double tap : tail) {
+        taps.push_back(tap * 1e-9);
+    }
+    // Same as loading a FIR with the default threshold.
+    const pair<size_t, size_t> range = FirDesign::getTrimRange(taps, FIR_TRIM_THRESHOLD_DB);
+    const size_t start = range.first, end = range.second;
+    // Both ends together stay within the threshold.
+    const vector<double> kept(taps.begin() + start, taps.begin() + end);
+    const double removed = FirDesign::getEnergy(vector<double>(taps.begin(), taps.begin() + start))
+        + FirDesign::getEnergy(vector<double>(taps.begin() + end, taps.end()));
+    const double removedDb = 10 * log10(removed / FirDesign::getEnergy(taps));
+    FilterDelay delay(TEST_SAMPLE_RATE, 1000.0 * start / TEST_SAMPLE_RATE);
+    FilterFir trimmed(kept);
+    FilterFir original(taps);
+    const vector<double> input = createNoise(TEST_BLOCK_SIZE * 40);
+    const vector<double> expected = processUneven(original, input);
+    const vector<double> result = processUneven(trimmed, processUneven(delay, input));
+    const double errorDb = getErrorDb(expected, result);
+    const bool isOk = start >= numLeading / 2 && end <= taps.size() - numTrailing / 2 && delay.getSize() == start && removedDb < FIR_TRIM_THRESHOLD_DB && errorDb < -120;
+    printf("%zu -> %zu taps, delay %u samples, removed energy %6.1f dB, max error %6.1f dB  %s\n",
+        taps.size(), end - start, delay.getSize(), removedDb, errorDb, isOk ? "OK" : "FAILED");
+    printf("\n");
+    return isOk;
+}
+
+const bool testLinearPhase() {
+    printf("Linear phase FIR\n");
+    bool isAllOk = true;
+    for (const bool isLowPass : { true, false }) {
+        FilterBiquad biquad(TEST_SAMPLE_RATE);
+        biquad.addCrossover(isLowPass, isLowPass ? 80 : 2000, CrossoverType::LINKWITZ_RILEY, 4);
+        const vector<double> taps = FirDesign::linearPhase(biquad.getBiquads(), LINEAR_PHASE_TAPS);
+        double asymmetry = 0, peak = 0;
+        for (size_t i = 0; i < taps.size(); ++i) {
+            asymmetry = std::max(asymmetry, std::abs(taps[i] - taps[taps.size() - 1 - i]));
+            peak = std::max(peak, std::abs(taps[i]));
+        }
+        // Magnitude of the taps against the biquads, where the response is above the window's attenuation.
+        double errorDb = 0;
+        for (const double frequency : { 20.0, 50.0, 80.0, 150.0, 1000.0, 2000.0, 4000.0, 15000.0 }) {
+            const double expectedDb = 20 * log10(FirDesign::getMagnitude(biquad.getBiquads(), frequency / TEST_SAMPLE_RATE));
+            if (expectedDb < -LINEAR_PHASE_WINDOW_ATTENUATION / 2) {
+                continue;
+            }
+            std::complex<double> response = 0;
+            for (size_t i = 0; i < taps.size(); ++i) {
+                response += taps[i] * std::polar(1.0, -2 * M_PI * frequency * i / TEST_SAMPLE_RATE);
+            }
+            errorDb = std::max(errorDb, std::abs(20 * log10(std::abs(response)) - expectedDb));
+        }
+        const bool isOk = taps.size() % 2 == 1 && asymmetry <= peak * 1e-12 && errorDb < 0.1;
+        printf("LR4 %s, %zu taps, asymmetry %.1e, max magnitude error %.4f dB  %s\n",
+            isLowPass ? "low pass 80Hz" : "high pass 2kHz", taps.size(), asymmetry / peak, errorDb, isOk ? "OK" : "FAILED");
+        isAllOk = isAllOk && isOk;
+    }
+    printf("\n");
+    return isAllOk;
+}
+
+// Reported latency of the filters plus the delays appended after the first numFilters by alignment.
+const size_t getAlignedLatency(const vector<unique_ptr<Filter>>& filters, const size_t numFilters) {
+    size_t result = Latency::getLatency(filters);
+    for (size_t i = numFilters; i < filters.size(); ++i) {
+        result += ((FilterDelay*)filters[i].get())->getSize();
+    }
+    return result;
+}
+
+const bool testLatency() {
+    printf("Latency compensation\n");
+    bool isAllOk = true;
+    for (const uint32_t sampleRate : { 44100, 48000, 88200, 96000, 176400, 192000 }) {
+        // Delays are configured in milliseconds. The round trip must give back the exact number of samples.
+        size_t numRoundTripErrors = 0;
+        for (size_t i = 1; i <= 100000; ++i) {
+            if (FilterDelay::getSampleDelay(sampleRate, 1000.0 * i / sampleRate) != i) {
+                ++numRoundTripErrors;
+            }
+        }
+        // Two outputs, each with two routes. One route is behind a bus.
+        const size_t busLatency = 4095;
+        vector<vector<vector<unique_ptr<Filter>>>> routes(2);
+        vector<vector<unique_ptr<Filter>>> outputs(2);
+        const size_t routeGroupDelays[2][2] = { { 0, 12345 }, { 1, 777 } };
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 2; ++j) {
+                routes[i].emplace_back();
+                routes[i][j].push_back(make_unique<FilterFir>(createTaps(100, 1), 0, false, routeGroupDelays[i][j]));
+            }
+        }
+        outputs[0].push_back(make_unique<FilterFir>(createTaps(3000, 2), FIR_FFT_PARTITION_SIZE, false, 1499));
+        outputs[1].push_back(make_unique<FilterGain>(-3.0));
+        vector<Latency::Path> outputPaths;
+        for (size_t i = 0; i < 2; ++i) {
+            const size_t routeLatency = Latency::align(sampleRate, { { &routes[i][0], 0 }, { &routes[i][1], busLatency } });
+            outputPaths.push_back({ &outputs[i], routeLatency });
+        }
+        const size_t latency = Latency::align(sampleRate, outputPaths);
+        // Every path from a route to an output arrives at the same time.
+        bool isAligned = true;
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 2; ++j) {
+                const size_t pathLatency = (j ? busLatency : 0) + getAlignedLatency(routes[i][j], 1) + getAlignedLatency(outputs[i], 1);
+                isAligned = isAligned && pathLatency == latency;
+            }
+        }
+        const bool isOk = numRoundTripErrors == 0 && isAligned;
+        printf("%uHz, latency %zu samples, %zu round trip errors, %s  %s\n",
+            sampleRate, latency, numRoundTripErrors, isAligned ? "aligned" : "not aligned", isOk ? "OK" : "FAILED");
+        isAllOk = isAllOk && isOk;
+    }
+    printf("\n");
+    return isAllOk;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+    Correctness tests for the DSP library.
+    Results are printed to stdout. Each test returns false if it failed.
+*/
+
+#pragma once
+
+// Optimized filter lists must give the same output as the original lists.
+const bool testFilterOptimizer();
+
+// FFT against a naive DFT, and inverse(forward(x)) against x up to the largest size.
+const bool testFFT();
+
+// Batched convolution against one partitioned convolver per path, mixed per output.
+const bool testConvolutionMatrix();
+
+// Mixing matrix against scalar accumulation of every route.
+const bool testMixingMatrix();
+
+// Filters relocated into an arena half way through a signal against the same filters left in place.
+const bool testFilterArena();
+
+// Unrolled interleave of common channel counts and the generic fallback against direct indexing.
+const bool testInterleave();
+
+// FFT convolution against direct form, delayed by one partition.
+const bool testFirFft();
+
+// Zero latency partitioned convolution against direct form.
+const bool testFirZeroLatency();
+
+// Biquad cascade converted to parallel sections against the cascade.
+const bool testBiquadParallel();
+
+// Biquad sections in state space block form against the cascade.
+const bool testBiquadStateSpace();
+
+// Biquad bank against one cascade per lane.
+const bool testBiquadBank();
+
+// Half-band decimation by eight: passband gain and rejection of content aliasing into the passband.
+const bool testHalfBand();
+
+// Resampled sines against ideal sines at the output rate, and rejection of content above the lower Nyquist frequency.
+const bool testResampler();
+
+// Minimum phase conversion of a linear phase FIR: magnitude response kept, energy moved to the start.
+const bool testMinimumPhase();
+
+// Trimmed FIR with its leading taps replaced by a delay against the untrimmed FIR.
+const bool testFirTrim();
+
+// Linear phase FIR against the magnitude of its biquads, and symmetry of its taps.
+const bool testLinearPhase();
+
+// Delays added by latency compensation against the latency of every path. Includes the round trip through milliseconds.
+const bool testLatency();
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "Bus.h"
+
+using std::move;
+
+Bus::Bus() {
+}
+
+void Bus::addSource(const size_t inputIndex, const double gain) {
+    // Same input twice is one source with the summed gain.
+    for (Source& source : _sources) {
+        if (source.inputIndex == inputIndex) {
+            source.gain += gain;
+            return;
+        }
+    }
+    _sources.push_back({ inputIndex, gain });
+}
+
+const vector<Bus::Source>& Bus::getSources() const {
+    return _sources;
+}
+
+void Bus::addFilter(unique_ptr<Filter> pFilter) {
+    _filters.push_back(move(pFilter));
+}
+
+const vector<unique_ptr<Filter>>& Bus::getFilters() const {
+    return _filters;
+}
+
+vector<unique_ptr<Filter>>& Bus::getFilters() {
+    return _filters;
+}
+
+void Bus::addRoute(Route& route) {
+    _routes.push_back(move(route));
+}
+
+const vector<Route>& Bus::getRoutes() const {
+    return _routes;
+}
+
+vector<Route>& Bus::getRoutes() {
+    return _routes;
+}
+
+void Bus::reset() const {
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        pFilter->reset();
+    }
+    for (const Route& route : _routes) {
+        route.reset();
+    }
+}
\ No newline at end of file
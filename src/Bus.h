@@ -0,0 +1,72 @@
+/*
+    This class represents a shared filter chain in the optimized routing plan.
+    A bus mixes one or more inputs with a gain each, runs its filters once and feeds its routes.
+    Created by the route optimizer for routes with identical filters or a common filter prefix.
+
+    Author: Andreas Arvidsson
+    Source: https://github.com/AndreasArvidsson/WinDSP
+*/
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstring> // memset
+#include "Filter.h"
+#include "Route.h"
+
+using std::vector;
+using std::unique_ptr;
+
+class Bus {
+public:
+
+    struct Source {
+        size_t inputIndex;
+        double gain;
+    };
+
+    Bus();
+
+    void addSource(const size_t inputIndex, const double gain);
+    const vector<Source>& getSources() const;
+    void addFilter(unique_ptr<Filter> pFilter);
+    const vector<unique_ptr<Filter>>& getFilters() const;
+    vector<unique_ptr<Filter>>& getFilters();
+    void addRoute(Route& route);
+    const vector<Route>& getRoutes() const;
+    vector<Route>& getRoutes();
+    void reset() const;
+
+    // Mix the sources, run the filters and route the result to the outputs.
+    // pBuffer and pRouteBuffer are scratch buffers of at least numSamples size.
+    inline void process(const double* const* const pInputBuffers, double* const* const pRenderBuffers, double* const pBuffer, double* const pRouteBuffer, const size_t numSamples) const {
+        // A single source without gain is read directly by the first filter.
+        const double* pIn = pBuffer;
+        if (_sources.size() == 1 && _sources[0].gain == 1.0) {
+            pIn = pInputBuffers[_sources[0].inputIndex];
+        }
+        else {
+            memset(pBuffer, 0, numSamples * sizeof(double));
+            for (const Source& source : _sources) {
+                const double* const pData = pInputBuffers[source.inputIndex];
+                const double gain = source.gain;
+                for (size_t i = 0; i < numSamples; ++i) {
+                    pBuffer[i] += gain * pData[i];
+                }
+            }
+        }
+        for (const unique_ptr<Filter>& pFilter : _filters) {
+            pFilter->process(pIn, pBuffer, numSamples);
+            pIn = pBuffer;
+        }
+        for (const Route& route : _routes) {
+            route.process(pBuffer, pRenderBuffers, pRouteBuffer, numSamples);
+        }
+    }
+
+private:
+    vector<Source> _sources;
+    vector<unique_ptr<Filter>> _filters;
+    vector<Route> _routes;
+
+};
\ No newline at end of file
@@ -12,6 +12,23 @@
 #include "AsioDevice.h"
 #include "Input.h"
 #include "Output.h"
+#include "Bus.h"
+#include "FilterBiquad.h"
+#include "BiquadBank.h"
+#include "FilterFir.h"
+#include "ConvolutionMatrix.h"
+#include "MixingMatrix.h"
+#include "FilterArena.h"
+#include "Denormal.h"
+#include "Resampler.h"
+#include <map>
+#include <set>
+
+using std::make_unique;
+using std::map;
+
+// Max number of frames processed per block. Larger capture packets are split into multiple blocks.
+#define MAX_BLOCK_SIZE 512
 
 // #define PERFORMANCE_LOG
 
@@ -29,10 +46,61 @@ CaptureLoop::CaptureLoop(const shared_ptr<Config> pConfig, unique_ptr<AudioDevic
     _pConfig = pConfig;
     _pInputs = &pConfig->getInputs();
     _pOutputs = &pConfig->getOutputs();
+    _pBuses = &pConfig->getBuses();
+    _usedInputs = pConfig->getUsedInputs();
+    _usedOutputs = pConfig->getUsedOutputs();
     _pCaptureDevice = move(pCaptureDevice);
     _pRenderDevice = move(pRenderDevice);
     _run = false;
 
+    // Capture frames are resampled to the render sample rate before routing. One resampler per input channel.
+    const uint32_t captureSampleRate = _pCaptureDevice->getFormat()->nSamplesPerSec;
+    if (captureSampleRate != pConfig->getSampleRate()) {
+        for (size_t i = 0; i < _pInputs->size(); ++i) {
+            _resamplers.push_back(make_unique<Resampler>(captureSampleRate, pConfig->getSampleRate(), MAX_BLOCK_SIZE));
+        }
+    }
+    _maxBlockSize = _resamplers.size() ? _resamplers[0]->getMaxOutputSize(MAX_BLOCK_SIZE) : MAX_BLOCK_SIZE;
+
+    // Allocate one block buffer per input and output channel plus scratch buffers for route and bus filters.
+    _pInputBuffer = make_unique<double[]>(_pInputs->size() * _maxBlockSize);
+    _pOutputBuffer = make_unique<double[]>(_pOutputs->size() * _maxBlockSize);
+    _pRouteBuffer = make_unique<double[]>(_maxBlockSize);
+    _pBusBuffer = make_unique<double[]>(_maxBlockSize);
+    for (size_t i = 0; i < _pInputs->size(); ++i) {
+        _inputBuffers.push_back(_pInputBuffer.get() + i * _maxBlockSize);
+    }
+    for (size_t i = 0; i < _pOutputs->size(); ++i) {
+        _outputBuffers.push_back(_pOutputBuffer.get() + i * _maxBlockSize);
+    }
+    // Capture blocks before resampling.
+    if (_resamplers.size()) {
+        _pCaptureBuffer = make_unique<double[]>(_pInputs->size() * MAX_BLOCK_SIZE);
+        for (size_t i = 0; i < _pInputs->size(); ++i) {
+            _captureBuffers.push_back(_pCaptureBuffer.get() + i * MAX_BLOCK_SIZE);
+        }
+    }
+
+    _deinterleave = Interleave::getDeinterleaver(_pInputs->size());
+    _interleave = Interleave::getInterleaver(_pOutputs->size());
+    if (pConfig->inDebug()) {
+        LOG_DEBUG("Interleave: %zu inputs %s, %zu outputs %s",
+            _pInputs->size(), Interleave::isSpecialized(_pInputs->size()) ? "unrolled" : "generic",
+            _pOutputs->size(), Interleave::isSpecialized(_pOutputs->size()) ? "unrolled" : "generic"
+        );
+    }
+
+    // Run identical biquad cascades on different outputs in parallel.
+    _initBiquadBanks();
+    _initConvolutionMatrices();
+    _initMixingMatrix();
+    // Compile the processing plan into one block of memory.
+    _initFilterArena();
+
+    // Without FTZ support noise is the only denormal protection.
+    _useDenormalNoise = pConfig->useDenormalNoise() || !Denormal::isFlushToZeroSupported();
+    _denormalNoiseSeed = 1;
+
     // Initialize conditions
     Condition::init(_pInputs->size());
 }
@@ -104,17 +172,17 @@ void CaptureLoop::run() {
 }
 
 void CaptureLoop::_captureLoopAsio() {
-    // Used to temporarily store sample(for all out channels) while they are being processed.
-    double renderBlockBuffer[32];
-    // The size of all sample frames for all channels with the same sample index/timestamp
-    const size_t renderBlockSize = sizeof(double) * _pOutputs->size();
+    const size_t numInputs = _pInputs->size();
+    const size_t numOutputs = _pOutputs->size();
     UINT32 samplesAvailable;
     DWORD flags;
     float* pCaptureBuffer;
-    double* pRenderBlockBuffer;
     bool silent = true;
     bool first = true;
 
+    // Decaying filter states in silence must not become denormals.
+    Denormal::setFlushToZero(true);
+
     // Wait until ASIO service has started.
     while (!AsioDevice::isRunning());
 
@@ -160,7 +228,8 @@ void CaptureLoop::_captureLoopAsio() {
                 }
 
                 // Render silence to asio to create the buffers at once. If not the first audio will be crackling.
-                for (UINT32 sampleIndex = 0; sampleIndex < samplesAvailable; ++sampleIndex) {
+                const size_t numRenderSamples = _getNumRenderSamples(samplesAvailable);
+                for (size_t sampleIndex = 0; sampleIndex < numRenderSamples; ++sampleIndex) {
                     for (UINT32 i = 0; i < _pOutputs->size(); ++i) {
                         AsioDevice::addSample(0);
                     }
@@ -169,20 +238,16 @@ void CaptureLoop::_captureLoopAsio() {
 
             swStart();
 
-            // Iterate all capture frames
-            for (UINT32 sampleIndex = 0; sampleIndex < samplesAvailable; ++sampleIndex) {
-                // Set buffer default value to 0 so we can add/mix values to it later
-                memset(renderBlockBuffer, 0, renderBlockSize);
+            // Process capture frames in blocks
+            for (UINT32 offset = 0; offset < samplesAvailable; offset += MAX_BLOCK_SIZE) {
+                const size_t numSamples = samplesAvailable - offset < MAX_BLOCK_SIZE ? samplesAvailable - offset : MAX_BLOCK_SIZE;
+                const size_t numRenderSamples = _processBlock(pCaptureBuffer + offset * numInputs, numSamples);
 
-                // Iterate inputs and route samples to outputs
-                for (Input& input : *_pInputs) {
-                    input.route(*pCaptureBuffer++, renderBlockBuffer);
-                }
-
-                // Iterate outputs and apply filters
-                pRenderBlockBuffer = renderBlockBuffer - 1;
-                for (Output& output : *_pOutputs) {
-                    AsioDevice::addSample(output.process(*++pRenderBlockBuffer));
+                // Interleave output blocks into the ASIO buffer
+                for (size_t sampleIndex = 0; sampleIndex < numRenderSamples; ++sampleIndex) {
+                    for (size_t i = 0; i < numOutputs; ++i) {
+                        AsioDevice::addSample(_outputBuffers[i][sampleIndex]);
+                    }
                 }
             }
 
@@ -201,17 +266,17 @@ void CaptureLoop::_captureLoopAsio() {
 }
 
 void CaptureLoop::_captureLoopWasapi() {
-    // Used to temporarily store sample(for all out channels) while they are being processed.
-    double renderBlockBuffer[8];
-    // The size of all sample frames for all channels with the same sample index/timestamp
-    const size_t renderBlockSize = sizeof(double) * _pOutputs->size();
+    const size_t numInputs = _pInputs->size();
+    const size_t numOutputs = _pOutputs->size();
     UINT32 samplesAvailable;
     DWORD flags;
     float* pCaptureBuffer, * pRenderBuffer;
-    double* pRenderBlockBuffer;
     bool silent = true;
     bool first = true;
 
+    // Decaying filter states in silence must not become denormals.
+    Denormal::setFlushToZero(true);
+
     while (_run) {
         // Check for samples in capture buffer.
         assert(_pCaptureDevice->getNextPacketSize(&samplesAvailable));
@@ -255,37 +320,34 @@ void CaptureLoop::_captureLoopWasapi() {
                 }
             }
 
+            // Number of frames after resampling to the render sample rate.
+            const UINT32 renderSamplesAvailable = (UINT32)_getNumRenderSamples(samplesAvailable);
+
             // Must read entire capture buffer at once. Wait until render buffer has enough space available.
-            while (samplesAvailable > _pRenderDevice->getBufferFrameCountAvailable() && _run);
+            while (renderSamplesAvailable > _pRenderDevice->getBufferFrameCountAvailable() && _run);
 
             // Get render buffer
-            assert(_pRenderDevice->getRenderBuffer(&pRenderBuffer, samplesAvailable));
+            assert(_pRenderDevice->getRenderBuffer(&pRenderBuffer, renderSamplesAvailable));
 
             if (pRenderBuffer) {
                 swStart();
 
-                // Iterate all capture frames
-                for (UINT32 sampleIndex = 0; sampleIndex < samplesAvailable; ++sampleIndex) {
-                    // Set buffer default value to 0 so we can add/mix values to it later
-                    memset(renderBlockBuffer, 0, renderBlockSize);
-
-                    // Iterate inputs and route samples to outputs
-                    for (Input& input : *_pInputs) {
-                        input.route(*pCaptureBuffer++, renderBlockBuffer);
-                    }
+                // Process capture frames in blocks
+                size_t renderOffset = 0;
+                for (UINT32 offset = 0; offset < samplesAvailable; offset += MAX_BLOCK_SIZE) {
+                    const size_t numSamples = samplesAvailable - offset < MAX_BLOCK_SIZE ? samplesAvailable - offset : MAX_BLOCK_SIZE;
+                    const size_t numRenderSamples = _processBlock(pCaptureBuffer + offset * numInputs, numSamples);
 
-                    // Iterate outputs and apply filters
-                    pRenderBlockBuffer = renderBlockBuffer - 1;
-                    for (Output& output : *_pOutputs) {
-                        *pRenderBuffer++ = (float)output.process(*++pRenderBlockBuffer);
-                    }
+                    // Interleave output blocks into the render buffer
+                    _interleave(_outputBuffers.data(), pRenderBuffer + renderOffset * numOutputs, numOutputs, numRenderSamples);
+                    renderOffset += numRenderSamples;
                 }
 
                 swEnd();
             }
 
             // Release render buffer.
-            assert(_pRenderDevice->releaseRenderBuffer(samplesAvailable));
+            assert(_pRenderDevice->releaseRenderBuffer(renderSamplesAvailable));
 
             // Release capture buffer.
             assert(_pCaptureDevice->releaseCaptureBuffer(samplesAvailable));
@@ -299,14 +361,285 @@ void CaptureLoop::_captureLoopWasapi() {
     }
 }
 
+const size_t CaptureLoop::_processBlock(const float* const pCaptureBuffer, const size_t numCaptureSamples) {
+    const size_t numInputs = _pInputs->size();
+    const size_t numOutputs = _pOutputs->size();
+
+    // Deinterleave capture frames into one block per input channel
+    const vector<double*>& deinterleaveBuffers = _resamplers.empty() ? _inputBuffers : _captureBuffers;
+    _deinterleave(pCaptureBuffer, deinterleaveBuffers.data(), numInputs, numCaptureSamples);
+
+    // Convert to the render sample rate. All resamplers have the same phase and produce the same number of samples.
+    size_t numSamples = numCaptureSamples;
+    for (size_t i = 0; i < _resamplers.size(); ++i) {
+        numSamples = _resamplers[i]->process(_captureBuffers[i], numCaptureSamples, _inputBuffers[i]);
+    }
+
+    // Set output blocks to 0 so we can add/mix values to them later
+    for (size_t i = 0; i < numOutputs; ++i) {
+        memset(_outputBuffers[i], 0, numSamples * sizeof(double));
+    }
+
+    // Iterate inputs and route blocks to outputs. Gain only routes are mixed by the matrix afterwards.
+    for (size_t i = 0; i < numInputs; ++i) {
+        Input& input = (*_pInputs)[i];
+        input.updateIsPlaying(_inputBuffers[i], numSamples);
+        if (!_usedInputs[i]) {
+            continue;
+        }
+        // Noise is added after the playing check so that silence is still detected.
+        if (_useDenormalNoise) {
+            Denormal::addNoise(_inputBuffers[i], numSamples, _denormalNoiseSeed);
+        }
+        input.route(_inputBuffers[i], _outputBuffers.data(), _pRouteBuffer.get(), numSamples);
+    }
+
+    // Shared filter chains of the optimized routing.
+    for (const Bus& bus : *_pBuses) {
+        bus.process(_inputBuffers.data(), _outputBuffers.data(), _pBusBuffer.get(), _pRouteBuffer.get(), numSamples);
+    }
+
+    if (_pMixingMatrix) {
+        _pMixingMatrix->process(_inputBuffers.data(), _outputBuffers.data(), numSamples);
+    }
+
+    // Batched FIR routes. One forward transform per input and one inverse transform per output.
+    for (const unique_ptr<ConvolutionMatrix>& pMatrix : _convolutionMatrices) {
+        pMatrix->process(_inputBuffers.data(), _outputBuffers.data(), numSamples);
+    }
+
+    // Iterate outputs and apply filters. Banked outputs stop before their biquad filter.
+    // Muted and unused outputs have nothing routed to them and stay silent.
+    for (size_t i = 0; i < numOutputs; ++i) {
+        if (!_usedOutputs[i]) {
+            continue;
+        }
+        Output& output = (*_pOutputs)[i];
+        if (output.hasBankFilter()) {
+            output.processPreBank(_outputBuffers[i], numSamples);
+        }
+        else {
+            output.process(_outputBuffers[i], numSamples);
+        }
+    }
+
+    // Process banked biquad filters and the rest of the banked outputs filters.
+    if (_biquadBanks.size()) {
+        for (size_t i = 0; i < _biquadBanks.size(); ++i) {
+            _biquadBanks[i]->process(_biquadBankBuffers[i].data(), numSamples);
+        }
+        for (size_t i = 0; i < numOutputs; ++i) {
+            Output& output = (*_pOutputs)[i];
+            if (output.hasBankFilter()) {
+                output.processPostBank(_outputBuffers[i], numSamples);
+            }
+        }
+    }
+
+    return numSamples;
+}
+
+const size_t CaptureLoop::_getNumRenderSamples(const size_t numCaptureSamples) const {
+    return _resamplers.empty() ? numCaptureSamples : _resamplers[0]->getOutputSize(numCaptureSamples);
+}
+
+void CaptureLoop::_initBiquadBanks() {
+    // Outputs grouped by the number of sections in their first biquad filter. The config decides the groups.
+    for (const auto& e : _pConfig->getBiquadBanks()) {
+        vector<const FilterBiquad*> filters;
+        vector<double*> buffers;
+        for (const size_t outputIndex : e.second) {
+            Output& output = (*_pOutputs)[outputIndex];
+            const vector<unique_ptr<Filter>>& outputFilters = output.getFilters();
+            for (size_t i = 0; i < outputFilters.size(); ++i) {
+                if (typeid (*outputFilters[i]) == typeid (FilterBiquad)) {
+                    filters.push_back((FilterBiquad*)outputFilters[i].get());
+                    buffers.push_back(_outputBuffers[outputIndex]);
+                    output.setBankFilterIndex(i);
+                    break;
+                }
+            }
+        }
+        _biquadBanks.push_back(make_unique<BiquadBank>(filters));
+        _biquadBankBuffers.push_back(buffers);
+        if (_pConfig->inDebug()) {
+            LOG_DEBUG("Biquad bank: %zu outputs, %zu sections", filters.size(), e.first);
+        }
+    }
+}
+
+void CaptureLoop::_initConvolutionMatrices() {
+    // Group routes that are a single FFT convolved FIR by partition size. Key: partition size, Value: (input index, route)
+    // Conditional routes are left out since they can be switched off independently.
+    map<size_t, vector<std::pair<size_t, Route*>>> groups;
+    for (size_t i = 0; i < _pInputs->size(); ++i) {
+        for (Route& route : (*_pInputs)[i].getRoutes()) {
+            const vector<unique_ptr<Filter>>& filters = route.getFilters();
+            if (route.hasConditions() || filters.size() != 1 || typeid (*filters[0]) != typeid (FilterFir)) {
+                continue;
+            }
+            const size_t partitionSize = ((FilterFir*)filters[0].get())->getPartitionSize();
+            if (partitionSize) {
+                groups[partitionSize].push_back({ i, &route });
+            }
+        }
+    }
+    for (const auto& e : groups) {
+        vector<ConvolutionMatrix::Path> paths;
+        std::set<size_t> inputs, outputs;
+        for (const auto& entry : e.second) {
+            const FilterFir* const pFir = (FilterFir*)entry.second->getFilters()[0].get();
+            paths.push_back({ entry.first, entry.second->getChannelIndex(), pFir->getTaps() });
+            inputs.insert(entry.first);
+            outputs.insert(entry.second->getChannelIndex());
+        }
+        // Separate convolvers use two transforms per route. Only batch when routes share inputs or outputs.
+        if (inputs.size() + outputs.size() >= 2 * paths.size()) {
+            continue;
+        }
+        for (const auto& entry : e.second) {
+            entry.second->setBatched(true);
+        }
+        _convolutionMatrices.push_back(make_unique<ConvolutionMatrix>(paths, e.first));
+        if (_pConfig->inDebug()) {
+            LOG_DEBUG("Convolution matrix: %zu routes, %zu inputs, %zu outputs, partition size %zu", paths.size(), inputs.size(), outputs.size(), e.first);
+        }
+    }
+}
+
+void CaptureLoop::_initMixingMatrix() {
+    // Leading gains of the remaining routes are applied when mixing. Routes with nothing left are mixed by the matrix.
+    bool hasGainOnlyRoutes = false;
+    for (Input& input : *_pInputs) {
+        for (Route& route : input.getRoutes()) {
+            if (route.isBatched()) {
+                continue;
+            }
+            route.foldGainPrefix();
+            if (route.isGainOnly()) {
+                route.setBatched(true);
+                hasGainOnlyRoutes = true;
+            }
+        }
+    }
+    // Bus routes are processed by their bus. They still apply their leading gains when mixing.
+    for (Bus& bus : *_pBuses) {
+        for (Route& route : bus.getRoutes()) {
+            route.foldGainPrefix();
+        }
+    }
+    if (hasGainOnlyRoutes) {
+        _pMixingMatrix = make_unique<MixingMatrix>(_pInputs->size(), _pOutputs->size());
+        // Every gain only route is connected up front, also at gain 0, so gain updates never change the term lists.
+        for (size_t i = 0; i < _pInputs->size(); ++i) {
+            for (const Route& route : (*_pInputs)[i].getRoutes()) {
+                if (route.isBatched() && route.isGainOnly()) {
+                    _pMixingMatrix->connect(i, route.getChannelIndex());
+                }
+            }
+        }
+        _updateMixingMatrix();
+        if (_pConfig->inDebug()) {
+            LOG_DEBUG("Mixing matrix: %zu inputs, %zu outputs, %zu connections", _pInputs->size(), _pOutputs->size(), _pMixingMatrix->getNumConnections());
+        }
+    }
+}
+
+void CaptureLoop::_updateMixingMatrix() {
+    // Sum the gains of the currently valid routes. Conditional routes that are switched off give gain 0.
+    vector<double> gains(_pInputs->size() * _pOutputs->size());
+    vector<bool> isConnected(gains.size());
+    for (size_t i = 0; i < _pInputs->size(); ++i) {
+        for (const Route& route : (*_pInputs)[i].getRoutes()) {
+            if (route.isBatched() && route.isGainOnly()) {
+                const size_t index = route.getChannelIndex() * _pInputs->size() + i;
+                isConnected[index] = true;
+                if (route.isValid()) {
+                    gains[index] += route.getMixGain();
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < gains.size(); ++i) {
+        if (isConnected[i]) {
+            _pMixingMatrix->setGain(i % _pInputs->size(), i / _pInputs->size(), gains[i]);
+        }
+    }
+}
+
+void CaptureLoop::_initFilterArena() {
+    _pFilterArena = make_unique<FilterArena>([this](FilterArena& arena) {
+        _relocateFilters(arena);
+    }, _pConfig->useLargePages());
+    if (_pConfig->useLargePages() && !_pFilterArena->isLargePages()) {
+        LOG_WARN("WARNING: Large pages are not available. The \"Lock pages in memory\" user right is required.");
+    }
+    if (_pConfig->inDebug()) {
+        LOG_DEBUG("Filter arena: %zu buffers, %zu KB%s", _pFilterArena->getNumBuffers(), _pFilterArena->getSize() / 1024, _pFilterArena->isLargePages() ? ", large pages" : "");
+    }
+}
+
+void CaptureLoop::_relocateFilters(FilterArena& arena) {
+    // Same order as _processBlock(). Filters of batched routes and unused channels are never processed.
+    for (size_t i = 0; i < _pInputs->size(); ++i) {
+        if (!_usedInputs[i]) {
+            continue;
+        }
+        for (Route& route : (*_pInputs)[i].getRoutes()) {
+            if (route.isBatched()) {
+                continue;
+            }
+            for (unique_ptr<Filter>& pFilter : route.getFilters()) {
+                pFilter->relocate(arena);
+            }
+        }
+    }
+    for (Bus& bus : *_pBuses) {
+        for (unique_ptr<Filter>& pFilter : bus.getFilters()) {
+            pFilter->relocate(arena);
+        }
+        for (Route& route : bus.getRoutes()) {
+            for (unique_ptr<Filter>& pFilter : route.getFilters()) {
+                pFilter->relocate(arena);
+            }
+        }
+    }
+    for (unique_ptr<ConvolutionMatrix>& pMatrix : _convolutionMatrices) {
+        pMatrix->relocate(arena);
+    }
+    for (size_t i = 0; i < _pOutputs->size(); ++i) {
+        if (!_usedOutputs[i]) {
+            continue;
+        }
+        for (unique_ptr<Filter>& pFilter : (*_pOutputs)[i].getFilters()) {
+            pFilter->relocate(arena);
+        }
+    }
+    for (unique_ptr<BiquadBank>& pBiquadBank : _biquadBanks) {
+        pBiquadBank->relocate(arena);
+    }
+}
+
 void CaptureLoop::_resetFilters() {
     // Reset i/o filter states.
     for (Input& input : *_pInputs) {
         input.reset();
     }
+    for (const Bus& bus : *_pBuses) {
+        bus.reset();
+    }
     for (const Output& output : *_pOutputs) {
         output.reset();
     }
+    for (unique_ptr<BiquadBank>& pBiquadBank : _biquadBanks) {
+        pBiquadBank->reset();
+    }
+    for (unique_ptr<ConvolutionMatrix>& pMatrix : _convolutionMatrices) {
+        pMatrix->reset();
+    }
+    for (unique_ptr<Resampler>& pResampler : _resamplers) {
+        pResampler->reset();
+    }
 }
 
 void CaptureLoop::_checkConfig() {
@@ -340,6 +673,9 @@ void CaptureLoop::_updateConditionalRouting() {
         for (Input& input : *_pInputs) {
             input.evalConditions();
         }
+        if (_pMixingMatrix) {
+            _updateMixingMatrix();
+        }
     }
 }
 
@@ -1,7 +1,7 @@
 /*
     This class represents the continuous capture loop.
     As long as the application is running this class will:
-        1) Capture audio samples from the capture device
+        1) Capture audio samples from the capture device. Resampled if the render device uses another sample rate
         2) Route audio samples to the desired output channels on the render device
         3) Apply filters on routes and/or outputs
 
@@ -13,6 +13,8 @@
 #include <vector>
 #include <atomic>
 #include <thread>
+#include <cstdint>
+#include "Interleave.h"
 
 using std::shared_ptr;
 using std::unique_ptr;
@@ -24,6 +26,12 @@ class Config;
 class AudioDevice;
 class Input;
 class Output;
+class Bus;
+class BiquadBank;
+class ConvolutionMatrix;
+class MixingMatrix;
+class FilterArena;
+class Resampler;
 
 class CaptureLoop {
 public:
@@ -35,12 +43,39 @@ private:
     shared_ptr<Config> _pConfig;
     vector<Input> *_pInputs;
     vector<Output> *_pOutputs;
+    vector<Bus> *_pBuses;
+    // Inputs and outputs that are part of the processing plan.
+    vector<bool> _usedInputs, _usedOutputs;
+    unique_ptr<double[]> _pCaptureBuffer, _pInputBuffer, _pOutputBuffer, _pRouteBuffer, _pBusBuffer;
+    vector<double*> _captureBuffers, _inputBuffers, _outputBuffers;
+    // Chosen from the device channel counts. Common layouts have unrolled loops.
+    Interleave::Deinterleaver _deinterleave;
+    Interleave::Interleaver _interleave;
+    vector<unique_ptr<Resampler>> _resamplers;
+    size_t _maxBlockSize;
+    vector<unique_ptr<BiquadBank>> _biquadBanks;
+    vector<vector<double*>> _biquadBankBuffers;
+    vector<unique_ptr<ConvolutionMatrix>> _convolutionMatrices;
+    unique_ptr<MixingMatrix> _pMixingMatrix;
+    // Coefficients and states of all filters above. Freed with the capture loop on config change.
+    unique_ptr<FilterArena> _pFilterArena;
     unique_ptr<AudioDevice> _pCaptureDevice, _pRenderDevice;
     atomic<bool> _run;
     thread _captureThread;
+    uint32_t _denormalNoiseSeed;
+    bool _useDenormalNoise;
 
     void _captureLoopWasapi();
     void _captureLoopAsio();
+    void _initBiquadBanks();
+    void _initConvolutionMatrices();
+    void _initMixingMatrix();
+    void _updateMixingMatrix();
+    void _initFilterArena();
+    void _relocateFilters(FilterArena& arena);
+    // Returns number of samples in the output blocks.
+    const size_t _processBlock(const float* const pCaptureBuffer, const size_t numCaptureSamples);
+    const size_t _getNumRenderSamples(const size_t numCaptureSamples) const;
     void _resetFilters();
     void _checkConfig();
     void _checkClippingChannels();
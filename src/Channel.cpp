@@ -2,58 +2,40 @@
 #include "Error.h"
 #include "Str.h"
 
+// Max channel number accepted in a config.
+#define CHANNELS_MAX_NUMBER 1024
+
+static const char* const CHANNEL_NAMES[CHANNELS_NUM_NAMED] = {
+    "L", "R", "C", "SW", "SBL", "SBR", "SL", "SR", "TFL", "TFR", "TBL", "TBR"
+};
+
 const Channel Channels::fromString(const string &strIn) {
     const string str = String::toUpperCase(strIn);
-    if (str.compare("L") == 0) {
-        return Channel::L;
-    }
-    else if (str.compare("R") == 0) {
-        return Channel::R;
-    }
-    else if (str.compare("C") == 0) {
-        return Channel::C;
-    }
-    else if (str.compare("SW") == 0) {
-        return Channel::SW;
-    }
-    else if (str.compare("SL") == 0) {
-        return Channel::SL;
-    }
-    else if (str.compare("SR") == 0) {
-        return Channel::SR;
-    }
-    else if (str.compare("SBL") == 0) {
-        return Channel::SBL;
-    }
-    else if (str.compare("SBR") == 0) {
-        return Channel::SBR;
+    for (size_t i = 0; i < CHANNELS_NUM_NAMED; ++i) {
+        if (str.compare(CHANNEL_NAMES[i]) == 0) {
+            return (Channel)i;
+        }
+    }
+    // Channel number
+    if (!str.empty() && str.size() <= 4 && str.find_first_not_of("0123456789") == string::npos) {
+        const int number = std::stoi(str);
+        if (number >= 1 && number <= CHANNELS_MAX_NUMBER) {
+            return (Channel)(number - 1);
+        }
     }
     throw Error("Unknown channel '%s'", strIn.c_str());
 }
 
 const string Channels::toString(const Channel channel) {
-    switch (channel) {
-    case Channel::L:
-        return "L";
-    case Channel::R:
-        return "R";
-    case Channel::C:
-        return "C";
-    case Channel::SW:
-        return "SW";
-    case Channel::SL:
-        return "SL";
-    case Channel::SR:
-        return "SR";
-    case Channel::SBL:
-        return "SBL";
-    case Channel::SBR:
-        return "SBR";
-    default:
+    if (channel == Channel::CHANNEL_NULL) {
         throw Error("Unknown channel type %d", channel);
-    };
+    }
+    return toString((size_t)channel);
 }
 
 const string Channels::toString(const size_t channelIndex) {
-    return toString((Channel)channelIndex);
+    if (channelIndex < CHANNELS_NUM_NAMED) {
+        return CHANNEL_NAMES[channelIndex];
+    }
+    return std::to_string(channelIndex + 1);
 }
\ No newline at end of file
@@ -3,12 +3,18 @@
 
 using std::string;
 
+// Channels are identified by their index on the device. The first channels have names in the usual Windows order
+// up to 7.1.4. Any channel, also beyond the named ones, can be given by its number, eg. "16" is (Channel)15.
 enum class Channel {
-    L, R, C, SW, SBL, SBR, SL, SR, CHANNEL_NULL
+    L, R, C, SW, SBL, SBR, SL, SR, TFL, TFR, TBL, TBR, CHANNEL_NULL = -1
 };
 
+// Number of named channels.
+#define CHANNELS_NUM_NAMED 12
+
 namespace Channels {
 
+    // Channel name or number starting at 1.
     const Channel fromString(const string &str);
     const string toString(const Channel channel);
     const string toString(const size_t channelIndex);
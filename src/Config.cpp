@@ -3,12 +3,15 @@
 #include "Input.h"
 #include "Output.h"
 #include "FilterGain.h"
+#include "FilterMultirate.h"
+#include "Convert.h"
+#include "Str.h"
 #include "WinDSPLog.h"
 
 Config::Config(const string& path) {
     _configFile = path;
-    _hide = _minimize = _useConditionalRouting = _startWithOS = _addAutoGain = _debug = _useAsioRenderDevice = false;
-    _sampleRate = _numChannelsIn = _numChannelsOut = _asioBufferSize = _asioNumChannels = 0;
+    _hide = _minimize = _useConditionalRouting = _startWithOS = _addAutoGain = _debug = _useAsioRenderDevice = _useDenormalNoise = _useLargePages = false;
+    _sampleRate = _numChannelsIn = _numChannelsOut = _asioBufferSize = _asioNumChannels = _asioSampleRate = 0;
     _lastModified = 0;
     load();
     parseMisc();
@@ -22,6 +25,10 @@ void Config::init(const uint32_t sampleRate, const uint32_t numChannelsIn, const
     _useConditionalRouting = false;
     parseRouting();
     parseOutputs();
+    optimizeRouting();
+    reduceFilters();
+    compensateLatency();
+    optimizeFilters();
 }
 
 const string Config::getCaptureDeviceName() const {
@@ -40,6 +47,47 @@ vector<Output>& Config::getOutputs() {
     return _outputs;
 }
 
+vector<Bus>& Config::getBuses() {
+    return _buses;
+}
+
+const vector<bool> Config::getUsedInputs() const {
+    vector<bool> result(_inputs.size());
+    for (size_t i = 0; i < _inputs.size(); ++i) {
+        result[i] = !_inputs[i].getRoutes().empty();
+    }
+    for (const Bus& bus : _buses) {
+        for (const Bus::Source& source : bus.getSources()) {
+            result[source.inputIndex] = true;
+        }
+    }
+    return result;
+}
+
+const vector<bool> Config::getUsedOutputs() const {
+    vector<bool> result(_outputs.size());
+    for (const Input& input : _inputs) {
+        for (const Route& route : input.getRoutes()) {
+            result[route.getChannelIndex()] = true;
+        }
+    }
+    for (const Bus& bus : _buses) {
+        for (const Route& route : bus.getRoutes()) {
+            result[route.getChannelIndex()] = true;
+        }
+    }
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        if (_outputs[i].isMuted()) {
+            result[i] = false;
+        }
+    }
+    return result;
+}
+
+const map<size_t, vector<size_t>>& Config::getBiquadBanks() const {
+    return _biquadBanks;
+}
+
 const bool Config::startWithOS() const {
     return _startWithOS;
 }
@@ -59,6 +107,10 @@ const double Config::getFiltersLevelSum(const vector<unique_ptr<Filter>>& filter
             const FilterGain* pFilterGain = (FilterGain*)pFilter.get();
             startLevel *= pFilterGain->getMultiplierNoInvert();
         }
+        // Reduced rate filters: Apply their gain
+        else if (typeid (*pFilter.get()) == typeid (FilterMultirate)) {
+            startLevel = getFiltersLevelSum(((FilterMultirate*)pFilter.get())->getFilters(), startLevel);
+        }
     }
     return startLevel;
 }
@@ -97,10 +149,26 @@ const uint32_t Config::getAsioNumChannels() const {
     return _asioNumChannels;
 }
 
+const uint32_t Config::getAsioSampleRate() const {
+    return _asioSampleRate;
+}
+
+const uint32_t Config::getSampleRate() const {
+    return _sampleRate;
+}
+
 const bool Config::useConditionalRouting() const {
     return _useConditionalRouting;
 }
 
+const bool Config::useDenormalNoise() const {
+    return _useDenormalNoise;
+}
+
+const bool Config::useLargePages() const {
+    return _useLargePages;
+}
+
 const bool Config::hasChanged() const {
     return _lastModified != _configFile.getLastModifiedTime();
 }
@@ -130,18 +198,50 @@ void Config::printConfig() const {
     }
     LOG_NL();
 
+    if (_buses.size()) {
+        LOG_INFO("***** Buses *****");
+        LOG_NL();
+        for (size_t i = 0; i < _buses.size(); ++i) {
+            const Bus& bus = _buses[i];
+            string sources;
+            for (const Bus::Source& source : bus.getSources()) {
+                sources += (sources.empty() ? "" : ", ") + Channels::toString(source.inputIndex);
+                if (source.gain != 1.0) {
+                    sources += String::format("(%.2fdB%s)", Convert::levelToDb(std::abs(source.gain)), source.gain < 0 ? ", inverted" : "");
+                }
+            }
+            LOG_INFO("%s\t->\tBus %zu", sources.c_str(), i + 1);
+            printFilters("", bus.getFilters());
+            for (const Route& route : bus.getRoutes()) {
+                LOG_INFO("Bus %zu\t->\t%s", i + 1, Channels::toString(route.getChannel()).c_str());
+                printFilters("\t", route.getFilters());
+            }
+            LOG_NL();
+        }
+        LOG_NL();
+    }
+
     LOG_INFO("***** Outputs *****");
     LOG_NL();
-    for (const Output& output : _outputs) {
+    const vector<bool> usedOutputs = getUsedOutputs();
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        const Output& output = _outputs[i];
         if (output.isMuted()) {
             LOG_INFO("%s\tMUTE", Channels::toString(output.getChannel()).c_str());
         }
+        else if (!usedOutputs[i]) {
+            LOG_INFO("%s\tNOT USED", Channels::toString(output.getChannel()).c_str());
+        }
         else {
             LOG_INFO(Channels::toString(output.getChannel()).c_str());
             printFilters("", output.getFilters());
         }
         LOG_NL();
     }
+    if (_latency) {
+        LOG_INFO("Latency: %zd samples, %.1f ms", _latency, 1000.0 * _latency / _sampleRate);
+        LOG_NL();
+    }
     LOG_NL();
 }
 
@@ -9,14 +9,17 @@
 #pragma once
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <memory>
 #include "File.h"
 #include "Input.h"
 #include "Output.h"
+#include "Bus.h"
 
 using std::string;
 using std::vector;
 using std::unordered_map;
+using std::map;
 using std::shared_ptr;
 using std::unique_ptr;
 
@@ -40,6 +43,12 @@ public:
     const string getRenderDeviceName() const;
     vector<Input>& getInputs();
     vector<Output>& getOutputs();
+    vector<Bus>& getBuses();
+    // Inputs and outputs that are part of the processing plan. Unused ones can be skipped.
+    const vector<bool> getUsedInputs() const;
+    const vector<bool> getUsedOutputs() const;
+    // Used outputs whose biquad filter runs in a biquad bank. Key: num sections, Value: output indices. At least two per bank.
+    const map<size_t, vector<size_t>>& getBiquadBanks() const;
     const bool hide() const;
     const bool minimize() const;
     const bool startWithOS() const;
@@ -49,20 +58,27 @@ public:
     const bool useAsioRenderDevice() const;
     const uint32_t getAsioBufferSize() const;
     const uint32_t getAsioNumChannels() const;
+    const uint32_t getAsioSampleRate() const;
+    const uint32_t getSampleRate() const;
     const bool useConditionalRouting() const;
+    const bool useDenormalNoise() const;
+    const bool useLargePages() const;
     const bool hasChanged() const;
     void printConfig() const;
 
 private:
     vector<Input> _inputs;
     vector<Output> _outputs;
+    vector<Bus> _buses;
+    map<size_t, vector<size_t>> _biquadBanks;
     unordered_map<Channel, bool> _addLpTo, _addHpTo;
     File _configFile;
     shared_ptr<JsonNode> _pJsonNode, _pLpFilter, _pHpFilter;
     string _captureDeviceName, _renderDeviceName;
-    uint32_t _sampleRate, _numChannelsIn, _numChannelsOut, _asioBufferSize, _asioNumChannels;
+    size_t _latency;
+    uint32_t _sampleRate, _numChannelsIn, _numChannelsOut, _asioBufferSize, _asioNumChannels, _asioSampleRate;
     time_t _lastModified;
-    bool _hide, _minimize, _useConditionalRouting, _startWithOS, _addAutoGain, _debug, _useAsioRenderDevice;
+    bool _hide, _minimize, _useConditionalRouting, _startWithOS, _addAutoGain, _debug, _useAsioRenderDevice, _useDenormalNoise, _useLargePages;
 
     /* ********* Config.cpp ********* */
 
@@ -83,7 +99,10 @@ private:
     void parseOutput(const shared_ptr<JsonNode>& pOutputs, const size_t index, string path);
     const Channel getOutputChannel(const string& channelName, const string& path) const;
     const vector<Channel> getOutputChannels(const shared_ptr<JsonNode>& pOutputNode, const string& path) const;
+    const bool getUseFloat(const shared_ptr<JsonNode>& pOutputNode, const string& path) const;
+    const size_t getDecimation(const shared_ptr<JsonNode>& pOutputNode, const string& path) const;
     void validateLevels(const string& path);
+    void compensateLatency();
 
     /* ********* ConfigParserBasic.cpp ********* */
 
@@ -115,9 +134,12 @@ private:
 
     /* ********* ConfigParserFilter.cpp ********* */
 
-    vector<unique_ptr<Filter>> parseFilters(const shared_ptr<JsonNode>& pNode, const string& path, const int outputChannel = -1) const;
-    void parseFilter(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
-    void parseCrossover(const bool isLowPass, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
+    // Filters are created for sampleRate, which is lower than the render sample rate on decimated outputs.
+    vector<unique_ptr<Filter>> parseFilters(const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, const string& path, const int outputChannel = -1, const bool useFloat = false) const;
+    void parseFilter(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path, const bool useFloat) const;
+    void parseCrossover(const bool isLowPass, vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
+    const size_t getLinearPhaseTaps(const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
+    void addCrossover(const bool isLowPass, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     void parseShelf(const bool isLowShelf, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     void parsePEQ(FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     void parseBandPass(FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
@@ -125,18 +147,34 @@ private:
     void parseLinkwitzTransform(FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     void parseBiquad(FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, string path) const;
     void parseGain(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const string& path) const;
-    void parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const;
-    void parseCompression(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const;
-    void parseCancellation(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const;
-    void parseFir(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
-    void parseFirTxt(vector<unique_ptr<Filter>>& filters, const File& file, const string& path) const;
-    void parseFirWav(vector<unique_ptr<Filter>>& filters, const File& file, const string& path) const;
-    void applyCrossoversMap(FilterBiquad* pFilterBiquad, const Channel channel, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
+    void parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const;
+    void parseCompression(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const;
+    void parseCancellation(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const;
+    void parseFir(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path, const bool useFloat) const;
+    void trimFir(vector<unique_ptr<Filter>>& filters, vector<double>& taps, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path) const;
+    const size_t getFirPartitionSize(const shared_ptr<JsonNode>& pFilterNode, const size_t defaultSize, const string& path) const;
+    const vector<double> parseFirTxt(const File& file, const string& path) const;
+    const vector<double> parseFirWav(const File& file, const uint32_t sampleRate, const string& path) const;
+    void applyCrossoversMap(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const Channel channel, const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     void applyCrossoversMap(vector<unique_ptr<Filter>>& filters, const Channel channel) const;
     const double getQOffset(const shared_ptr<JsonNode>& pFilterNode, const string& path) const;
     const vector<double> getQValues(const shared_ptr<JsonNode>& pFilterNode, const int order, const string& path) const;
     const bool hasCrossoverFilter(const shared_ptr<JsonNode>& pFiltersNode, const bool isLowPass, const string& path) const;
 
+    /* ********* ConfigOptimizer.cpp ********* */
+
+    void optimizeRouting();
+    void mergeRoutes();
+    void hoistRoutePrefixes();
+    const bool isLinear(const vector<unique_ptr<Filter>>& filters) const;
+    // Number of leading gain filters. 0 if the rest isn't linear since the gains then can't be moved.
+    const size_t getGainPrefixSize(const vector<unique_ptr<Filter>>& filters) const;
+    const double getGainPrefixMultiplier(const vector<unique_ptr<Filter>>& filters) const;
+    void reduceFilters();
+    void optimizeFilters();
+    void initBiquadBanks();
+    void fuseFilters(vector<unique_ptr<Filter>>& filters) const;
+
     /* ********* ConfigParserUtil.cpp ********* */
 
     const shared_ptr<JsonNode> tryGetNode(const shared_ptr<JsonNode>& pNode, const string& field, string& path) const;
@@ -0,0 +1,293 @@
+#include "Config.h"
+#include "DSP.h"
+#include "FilterChain.h"
+#include "FilterOptimizer.h"
+#include "WinDSPLog.h"
+#include <map>
+
+using std::map;
+using std::move;
+
+void Config::optimizeRouting() {
+    // Muted outputs are silenced anyway. Drop the routes to them.
+    for (Input& input : _inputs) {
+        vector<Route>& routes = input.getRoutes();
+        for (size_t i = 0; i < routes.size();) {
+            if (_outputs[routes[i].getChannelIndex()].isMuted()) {
+                routes.erase(routes.begin() + i);
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+    mergeRoutes();
+    hoistRoutePrefixes();
+}
+
+void Config::mergeRoutes() {
+    // Routes into the same output with identical linear filters are summed before the filters, which then run once.
+    // Leading gains differ between eg. bass routes and become the gains of the bus sources.
+    vector<vector<bool>> merged(_inputs.size());
+    for (size_t i = 0; i < _inputs.size(); ++i) {
+        merged[i] = vector<bool>(_inputs[i].getRoutes().size());
+    }
+    for (size_t outputIndex = 0; outputIndex < _outputs.size(); ++outputIndex) {
+        // Candidates as (input index, route index)
+        vector<std::pair<size_t, size_t>> candidates;
+        for (size_t i = 0; i < _inputs.size(); ++i) {
+            const vector<Route>& routes = _inputs[i].getRoutes();
+            for (size_t j = 0; j < routes.size(); ++j) {
+                const Route& route = routes[j];
+                if (route.getChannelIndex() == outputIndex && !route.hasConditions() && isLinear(route.getFilters()) &&
+                    getGainPrefixSize(route.getFilters()) < route.getFilters().size()) {
+                    candidates.push_back({ i, j });
+                }
+            }
+        }
+        vector<bool> isGrouped(candidates.size());
+        for (size_t a = 0; a < candidates.size(); ++a) {
+            if (isGrouped[a]) {
+                continue;
+            }
+            const vector<unique_ptr<Filter>>& filtersA = _inputs[candidates[a].first].getRoutes()[candidates[a].second].getFilters();
+            const size_t startA = getGainPrefixSize(filtersA);
+            vector<size_t> group = { a };
+            for (size_t b = a + 1; b < candidates.size(); ++b) {
+                const vector<unique_ptr<Filter>>& filtersB = _inputs[candidates[b].first].getRoutes()[candidates[b].second].getFilters();
+                const size_t startB = getGainPrefixSize(filtersB);
+                if (isGrouped[b] || filtersA.size() - startA != filtersB.size() - startB) {
+                    continue;
+                }
+                bool isEqual = true;
+                for (size_t k = 0; isEqual && startA + k < filtersA.size(); ++k) {
+                    isEqual = FilterOptimizer::isEqual(*filtersA[startA + k], *filtersB[startB + k]);
+                }
+                if (isEqual) {
+                    group.push_back(b);
+                }
+            }
+            if (group.size() < 2) {
+                continue;
+            }
+            Bus bus;
+            for (const size_t c : group) {
+                isGrouped[c] = true;
+                const size_t inputIndex = candidates[c].first;
+                const size_t routeIndex = candidates[c].second;
+                bus.addSource(inputIndex, getGainPrefixMultiplier(_inputs[inputIndex].getRoutes()[routeIndex].getFilters()));
+                merged[inputIndex][routeIndex] = true;
+            }
+            vector<unique_ptr<Filter>>& filters = _inputs[candidates[a].first].getRoutes()[candidates[a].second].getFilters();
+            for (size_t k = startA; k < filters.size(); ++k) {
+                bus.addFilter(move(filters[k]));
+            }
+            Route route((Channel)outputIndex);
+            bus.addRoute(route);
+            _buses.push_back(move(bus));
+        }
+    }
+    for (size_t i = 0; i < _inputs.size(); ++i) {
+        vector<Route>& routes = _inputs[i].getRoutes();
+        for (size_t j = routes.size(); j-- > 0;) {
+            if (merged[i][j]) {
+                routes.erase(routes.begin() + j);
+            }
+        }
+    }
+}
+
+void Config::hoistRoutePrefixes() {
+    // Routes from the same input that start with the same filters share one bus for that prefix.
+    // Leading gains of linear routes stay in the routes, after the prefix.
+    for (size_t inputIndex = 0; inputIndex < _inputs.size(); ++inputIndex) {
+        vector<Route>& routes = _inputs[inputIndex].getRoutes();
+        vector<size_t> starts(routes.size());
+        vector<bool> isHoisted(routes.size());
+        for (size_t i = 0; i < routes.size(); ++i) {
+            starts[i] = getGainPrefixSize(routes[i].getFilters());
+        }
+        for (size_t a = 0; a < routes.size(); ++a) {
+            const vector<unique_ptr<Filter>>& filtersA = routes[a].getFilters();
+            if (isHoisted[a] || routes[a].hasConditions() || starts[a] == filtersA.size()) {
+                continue;
+            }
+            // Group by first filter. The prefix is what all routes in the group have in common.
+            vector<size_t> group = { a };
+            size_t prefixSize = filtersA.size() - starts[a];
+            for (size_t b = a + 1; b < routes.size(); ++b) {
+                const vector<unique_ptr<Filter>>& filtersB = routes[b].getFilters();
+                if (isHoisted[b] || routes[b].hasConditions()) {
+                    continue;
+                }
+                size_t size = 0;
+                while (size < prefixSize && starts[b] + size < filtersB.size() &&
+                    FilterOptimizer::isEqual(*filtersA[starts[a] + size], *filtersB[starts[b] + size])) {
+                    ++size;
+                }
+                if (size) {
+                    group.push_back(b);
+                    prefixSize = size;
+                }
+            }
+            if (group.size() < 2) {
+                continue;
+            }
+            Bus bus;
+            bus.addSource(inputIndex, 1.0);
+            for (size_t k = 0; k < prefixSize; ++k) {
+                bus.addFilter(move(routes[a].getFilters()[starts[a] + k]));
+            }
+            for (const size_t r : group) {
+                isHoisted[r] = true;
+                vector<unique_ptr<Filter>>& filters = routes[r].getFilters();
+                filters.erase(filters.begin() + starts[r], filters.begin() + starts[r] + prefixSize);
+                bus.addRoute(routes[r]);
+            }
+            _buses.push_back(move(bus));
+        }
+        for (size_t i = routes.size(); i-- > 0;) {
+            if (isHoisted[i]) {
+                routes.erase(routes.begin() + i);
+            }
+        }
+    }
+}
+
+const bool Config::isLinear(const vector<unique_ptr<Filter>>& filters) const {
+    for (const unique_ptr<Filter>& pFilter : filters) {
+        if (!FilterOptimizer::isLinear(*pFilter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const size_t Config::getGainPrefixSize(const vector<unique_ptr<Filter>>& filters) const {
+    if (!isLinear(filters)) {
+        return 0;
+    }
+    size_t size = 0;
+    while (size < filters.size() && typeid (*filters[size]) == typeid (FilterGain)) {
+        ++size;
+    }
+    return size;
+}
+
+const double Config::getGainPrefixMultiplier(const vector<unique_ptr<Filter>>& filters) const {
+    double result = 1.0;
+    for (size_t i = 0; i < getGainPrefixSize(filters); ++i) {
+        result *= ((FilterGain*)filters[i].get())->getMultiplier();
+    }
+    return result;
+}
+
+void Config::reduceFilters() {
+    // Runs before latency compensation. Merged FIRs can have less latency than the originals.
+    for (Input& input : _inputs) {
+        for (Route& route : input.getRoutes()) {
+            FilterOptimizer::optimize(route.getFilters());
+        }
+    }
+    for (Bus& bus : _buses) {
+        FilterOptimizer::optimize(bus.getFilters());
+        for (Route& route : bus.getRoutes()) {
+            FilterOptimizer::optimize(route.getFilters());
+        }
+    }
+    for (Output& output : _outputs) {
+        FilterOptimizer::optimize(output.getFilters());
+    }
+}
+
+void Config::optimizeFilters() {
+    // The bank needs the plain filter list, so banked outputs are not fused.
+    initBiquadBanks();
+    vector<bool> isBanked(_outputs.size());
+    for (const auto& e : _biquadBanks) {
+        for (const size_t outputIndex : e.second) {
+            isBanked[outputIndex] = true;
+        }
+    }
+
+    for (Input& input : _inputs) {
+        for (Route& route : input.getRoutes()) {
+            fuseFilters(route.getFilters());
+        }
+    }
+    for (Bus& bus : _buses) {
+        fuseFilters(bus.getFilters());
+        for (Route& route : bus.getRoutes()) {
+            fuseFilters(route.getFilters());
+        }
+    }
+
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        Output& output = _outputs[i];
+        if (!isBanked[i]) {
+            fuseFilters(output.getFilters());
+        }
+        // Filters of a decimated output run as their own list at the reduced rate.
+        for (const unique_ptr<Filter>& pFilter : output.getFilters()) {
+            if (typeid (*pFilter) == typeid (FilterMultirate)) {
+                fuseFilters(((FilterMultirate*)pFilter.get())->getFilters());
+            }
+        }
+    }
+}
+
+void Config::initBiquadBanks() {
+    // Used outputs sharing biquad section count with another used output run their first biquad filter in a bank
+    // in the capture loop. Decided here once so the filter fusion and the capture loop agree.
+    const vector<bool> usedOutputs = getUsedOutputs();
+    map<size_t, vector<size_t>> groups;
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        if (!usedOutputs[i]) {
+            continue;
+        }
+        for (const unique_ptr<Filter>& pFilter : _outputs[i].getFilters()) {
+            if (typeid (*pFilter) == typeid (FilterBiquad)) {
+                groups[((FilterBiquad*)pFilter.get())->size()].push_back(i);
+                break;
+            }
+        }
+    }
+    _biquadBanks.clear();
+    for (const auto& e : groups) {
+        // No use in a bank with a single lane.
+        if (e.second.size() > 1) {
+            _biquadBanks.insert(e);
+        }
+    }
+}
+
+void Config::fuseFilters(vector<unique_ptr<Filter>>& filters) const {
+    // A single filter is already one call per block.
+    if (filters.size() < 2) {
+        return;
+    }
+    // Common chain shapes. Order is the same as parseFilters creates them.
+    unique_ptr<Filter> pChain = FilterChain<FilterGain, FilterBiquad>::tryCreate(filters);
+    if (!pChain) {
+        pChain = FilterChain<FilterGain, FilterDelay>::tryCreate(filters);
+    }
+    if (!pChain) {
+        pChain = FilterChain<FilterDelay, FilterBiquad>::tryCreate(filters);
+    }
+    if (!pChain) {
+        pChain = FilterChain<FilterGain, FilterDelay, FilterBiquad>::tryCreate(filters);
+    }
+    if (!pChain) {
+        pChain = FilterChain<FilterBiquad, FilterCompression>::tryCreate(filters);
+    }
+    if (!pChain) {
+        pChain = FilterChain<FilterGain, FilterBiquad, FilterCompression>::tryCreate(filters);
+    }
+    if (!pChain) {
+        pChain = FilterChain<FilterGain, FilterDelay, FilterBiquad, FilterCompression>::tryCreate(filters);
+    }
+    // Other chains keep the generic filter list.
+    if (pChain) {
+        filters.push_back(move(pChain));
+    }
+}
\ No newline at end of file
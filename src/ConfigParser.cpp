@@ -5,7 +5,10 @@
 #include "Output.h"
 #include "Channel.h"
 #include "Convert.h"
+#include "FilterDelay.h"
 #include "FilterGain.h"
+#include "FilterMultirate.h"
+#include "Latency.h"
 #include "Visibility.h"
 #include "AudioDevice.h"
 #include "AsioDevice.h"
@@ -34,6 +37,7 @@ void Config::parseDevices() {
         _useAsioRenderDevice = tryGetBoolValue(pDevicesNode, "renderAsio", path);
         _asioBufferSize = tryGetIntValue(pDevicesNode, "asioBufferSize", path);
         _asioNumChannels = tryGetIntValue(pDevicesNode, "asioNumChannels", path);
+        _asioSampleRate = tryGetIntValue(pDevicesNode, "asioSampleRate", path);
     }
 }
 
@@ -43,6 +47,10 @@ void Config::parseMisc() {
     _minimize = tryGetBoolValue(_pJsonNode, "minimize", "");
     // Parse startup
     _startWithOS = tryGetBoolValue(_pJsonNode, "startWithOS", "");
+    // Parse denormal protection
+    _useDenormalNoise = tryGetBoolValue(_pJsonNode, "denormalNoise", "");
+    // Parse memory options
+    _useLargePages = tryGetBoolValue(_pJsonNode, "largePages", "");
     // Parse debug
     _debug = tryGetBoolValue(_pJsonNode, "debug", "");
     // Log to file in debug mode.
@@ -96,13 +104,46 @@ void Config::parseOutput(const shared_ptr<JsonNode>& pOutputs, const size_t inde
     for (const Channel channel : channels) {
         const bool mute = tryGetBoolValue(pOutputNode, "mute", path);
         Output output(channel, mute);
-        vector<unique_ptr<Filter>> filters = parseFilters(pOutputNode, path, (int)channel);
-        parseCancellation(filters, pOutputNode, path);
-        output.addFilters(filters);
+        const size_t decimation = getDecimation(pOutputNode, path);
+        // Filters on a decimated output are created for the reduced sample rate.
+        const uint32_t sampleRate = _sampleRate / (uint32_t)decimation;
+        vector<unique_ptr<Filter>> filters = parseFilters(pOutputNode, sampleRate, path, (int)channel, getUseFloat(pOutputNode, path));
+        parseCancellation(filters, pOutputNode, sampleRate, path);
+        if (decimation > 1) {
+            output.addFilter(make_unique<FilterMultirate>(_sampleRate, decimation, filters));
+        }
+        else {
+            output.addFilters(filters);
+        }
         _outputs[(size_t)channel] = move(output);
     }
 }
 
+const bool Config::getUseFloat(const shared_ptr<JsonNode>& pOutputNode, const string& path) const {
+    const string precision = tryGetTextValue(pOutputNode, "precision", path);
+    if (precision.empty() || precision.compare("double") == 0) {
+        return false;
+    }
+    if (precision.compare("float") == 0) {
+        return true;
+    }
+    throw Error("Config(%s/precision) - Unknown precision '%s'. Expected 'float' or 'double'", path.c_str(), precision.c_str());
+}
+
+const size_t Config::getDecimation(const shared_ptr<JsonNode>& pOutputNode, const string& path) const {
+    if (!pOutputNode->has("decimation")) {
+        return 1;
+    }
+    const int decimation = getIntValue(pOutputNode, "decimation", path);
+    if (!FilterMultirate::isValidFactor(decimation)) {
+        throw Error("Config(%s/decimation) - Decimation must be 2, 4, 8 or 16: %d", path.c_str(), decimation);
+    }
+    if (_sampleRate % decimation) {
+        throw Error("Config(%s/decimation) - Sample rate %d is not divisible by decimation %d", path.c_str(), _sampleRate, decimation);
+    }
+    return decimation;
+}
+
 const vector<Channel> Config::getOutputChannels(const shared_ptr<JsonNode>& pOutputNode, const string& path) const {
     vector<Channel> result;
     if (pOutputNode->has("channels")) {
@@ -201,6 +242,32 @@ void Config::validateLevels(const string& path) {
     }
 }
 
+void Config::compensateLatency() {
+    // Routes mixed into the same output must arrive at the same time. Delay the faster ones.
+    // Key: output index. Routes of a bus start with the latency of the bus filters.
+    vector<vector<Latency::Path>> routePaths(_outputs.size());
+    for (Input& input : _inputs) {
+        for (Route& route : input.getRoutes()) {
+            routePaths[route.getChannelIndex()].push_back({ &route.getFilters(), 0 });
+        }
+    }
+    for (Bus& bus : _buses) {
+        const size_t busLatency = Latency::getLatency(bus.getFilters());
+        for (Route& route : bus.getRoutes()) {
+            routePaths[route.getChannelIndex()].push_back({ &route.getFilters(), busLatency });
+        }
+    }
+    // Then delay all outputs to the slowest one.
+    vector<Latency::Path> outputPaths;
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        const size_t routeLatency = Latency::align(_sampleRate, routePaths[i]);
+        if (!_outputs[i].isMuted()) {
+            outputPaths.push_back({ &_outputs[i].getFilters(), routeLatency });
+        }
+    }
+    _latency = Latency::align(_sampleRate, outputPaths);
+}
+
 void Config::setDevices() {
     Visibility::show(true);
     const vector<string> wasapiDevices = AudioDevice::getDeviceNames();
@@ -38,6 +38,10 @@ void Config::parseInput(const shared_ptr<JsonNode>& pInputs, const string &chann
         }
         return;
     }
+    // Named and numbered channels can refer to the same input, eg. "L" and "1".
+    if (_inputs[channelIndex].isDefined()) {
+        throw Error("Config(%s) - Channel '%s' is already defiend/used", path.c_str(), Channels::toString(channelIn).c_str());
+    }
     Input input(channelIn);
     for (size_t i = 0; i < pRoutes->size(); ++i) {
         parseRoute(input, pRoutes, i, path);
@@ -57,7 +61,7 @@ void Config::parseRoute(Input& input, const shared_ptr<JsonNode>& pRoutes, const
             return;
         }
         Route route(channelOut);
-        vector<unique_ptr<Filter>> filters = parseFilters(pRouteNode, path);
+        vector<unique_ptr<Filter>> filters = parseFilters(pRouteNode, _sampleRate, path);
         route.addFilters(filters);
         parseConditions(route, pRouteNode, path);
         input.addRoute(route);
@@ -72,6 +76,9 @@ void Config::parseConditions(Route& route, const shared_ptr<JsonNode>& pRouteNod
         }
         const string channelName = getTextValue(pIfNode, "silent", path);
         const size_t channel = (size_t)Channels::fromString(channelName);
+        if (channel >= _numChannelsIn) {
+            throw Error("Config(%s/silent) - Capture device doesn't have channel '%s'", path.c_str(), channelName.c_str());
+        }
         route.addCondition(Condition(ConditionType::SILENT, (int)channel));
         _useConditionalRouting = true;
     }
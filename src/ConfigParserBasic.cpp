@@ -88,6 +88,11 @@ void Config::routeChannels(const unordered_map<Channel, SpeakerType>& channelsMa
     for (size_t i = 0; i < _numChannelsIn; ++i) {
         const Channel channel = (Channel)i;
         Input input(channel);
+        // Numbered channels have no speaker role in basic routing.
+        if (channelsMap.find(channel) == channelsMap.end()) {
+            _inputs[i] = move(input);
+            continue;
+        }
         const SpeakerType type = channelsMap.at(channel);
         switch (type) {
             // Route to matching speaker
@@ -134,6 +139,18 @@ void Config::downmix(const unordered_map<Channel, SpeakerType>& channelsMap, Inp
     case Channel::SBR:
         type = addRoute(channelsMap, input, { Channel::SR , Channel::R });
         break;
+    case Channel::TFL:
+        type = addRoute(channelsMap, input, { Channel::L });
+        break;
+    case Channel::TFR:
+        type = addRoute(channelsMap, input, { Channel::R });
+        break;
+    case Channel::TBL:
+        type = addRoute(channelsMap, input, { Channel::SBL, Channel::SL, Channel::L });
+        break;
+    case Channel::TBR:
+        type = addRoute(channelsMap, input, { Channel::SBR, Channel::SR, Channel::R });
+        break;
     case Channel::C: {
         const double gain = PHANTOM_CENTER_GAIN + centerGain;
         addRoute(input, Channel::L, gain);
@@ -181,11 +198,15 @@ void Config::addFrontBassRoute(Input& input, const bool stereoBass, const double
             // Route to left front channel
         case Channel::SL:
         case Channel::SBL:
+        case Channel::TFL:
+        case Channel::TBL:
             addRoute(input, Channel::L, gain, addLP);
             break;
             // Route to right front channel
         case Channel::SR:
         case Channel::SBR:
+        case Channel::TFR:
+        case Channel::TBR:
             addRoute(input, Channel::R, gain, addLP);
             break;
             // Route to both front channels
@@ -209,12 +230,16 @@ void Config::addSwRoute(Input& input, const bool stereoBass, const vector<Channe
         case Channel::L:
         case Channel::SL:
         case Channel::SBL:
+        case Channel::TFL:
+        case Channel::TBL:
             addRoutes(input, subLs, gain);
             break;
             // Route to right sub channels
         case Channel::R:
         case Channel::SR:
         case Channel::SBR:
+        case Channel::TFR:
+        case Channel::TBR:
             addRoutes(input, subRs, gain);
             break;
             // Route to both sub channels
@@ -241,6 +266,8 @@ const unordered_map<Channel, SpeakerType> Config::parseChannels(const shared_ptr
     parseChannel(result, pBasicNode, "center", { Channel::C }, allowed, path);
     parseChannel(result, pBasicNode, "surround", { Channel::SL, Channel::SR }, allowed, path);
     parseChannel(result, pBasicNode, "surroundBack", { Channel::SBL, Channel::SBR }, allowed, path);
+    // Height channels of 7.1.4 can't be subwoofers.
+    parseChannel(result, pBasicNode, "height", { Channel::TFL, Channel::TFR, Channel::TBL, Channel::TBR }, { SpeakerType::LARGE, SpeakerType::SMALL, SpeakerType::OFF }, path);
 
     // Fill type lists
     for (auto& e : result) {
@@ -343,10 +370,14 @@ void Config::addRoute(Input& input, const Channel channel, const double gain, co
         route.addFilter(make_unique<FilterGain>(gain));
     }
     if (addLP) {
+        vector<unique_ptr<Filter>> filters;
         unique_ptr<FilterBiquad> pFilterBiquad = make_unique<FilterBiquad>(_sampleRate);
         string lpPath = "basic";
-        parseCrossover(true, pFilterBiquad.get(), _pLpFilter, lpPath);
-        route.addFilter(move(pFilterBiquad));
+        parseCrossover(true, filters, pFilterBiquad.get(), _pLpFilter, lpPath);
+        if (!pFilterBiquad->isEmpty()) {
+            filters.push_back(move(pFilterBiquad));
+        }
+        route.addFilters(filters);
     }
     input.addRoute(route);
 }
@@ -11,35 +11,40 @@
 
 using std::make_unique;
 
-vector<unique_ptr<Filter>> Config::parseFilters(const shared_ptr<JsonNode>& pNode, const string& path, const int outputChannel) const {
+vector<unique_ptr<Filter>> Config::parseFilters(const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, const string& path, const int outputChannel, const bool useFloat) const {
     vector<unique_ptr<Filter>> filters;
     // Parse single instance simple filters.
     parseGain(filters, pNode, path);
-    parseDelay(filters, pNode, path);
+    parseDelay(filters, pNode, sampleRate, path);
 
-    unique_ptr<FilterBiquad> pFilterBiquad = make_unique<FilterBiquad>(_sampleRate);
+    unique_ptr<FilterBiquad> pFilterBiquad = make_unique<FilterBiquad>(sampleRate);
     string filtersPath = path;
     const shared_ptr<JsonNode> pFiltersNode = tryGetArrayNode(pNode, "filters", filtersPath);
 
     // Apply crossovers from basic config to outputs.
     if (outputChannel > -1) {
-        applyCrossoversMap(pFilterBiquad.get(), (Channel)outputChannel, pFiltersNode, filtersPath);
+        applyCrossoversMap(filters, pFilterBiquad.get(), (Channel)outputChannel, pFiltersNode, filtersPath);
     }
 
     // Parse filters list
     for (size_t i = 0; i < pFiltersNode->size(); ++i) {
         string filterPath = filtersPath;
         const shared_ptr<JsonNode> pFilter = getObjectNode(pFiltersNode, i, filterPath);
-        parseFilter(filters, pFilterBiquad.get(), pFilter, filterPath);
+        parseFilter(filters, pFilterBiquad.get(), pFilter, sampleRate, filterPath, useFloat);
     }
 
     // Use  biquad filter.
     if (!pFilterBiquad->isEmpty()) {
+        // Long cascades run as parallel sections when the conversion is safe. Otherwise each section runs in state space block form.
+        const bool isParallel = pFilterBiquad->size() >= BIQUAD_PARALLEL_MIN_SECTIONS && pFilterBiquad->compileParallel();
+        if (!isParallel) {
+            pFilterBiquad->compileStateSpace();
+        }
         filters.push_back(move(pFilterBiquad));
     }
 
     // Compression needs to be last so that it has the final samples to work on.
-    parseCompression(filters, pNode, path);
+    parseCompression(filters, pNode, sampleRate, path);
 
     return filters;
 }
@@ -53,7 +58,7 @@ void Config::parseGain(vector<unique_ptr<Filter>>& filters, const shared_ptr<Jso
     }
 }
 
-void Config::parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const {
+void Config::parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const {
     const shared_ptr<JsonNode> pFilterNode = tryGetNode(pNode, "delay", path);
     if (pFilterNode->isMissingNode()) {
         return;
@@ -72,9 +77,9 @@ void Config::parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<Js
     }
     // No use in adding zero delay.
     if (value != 0) {
-        const uint32_t sampleDelay = FilterDelay::getSampleDelay(_sampleRate, value, useUnitMeter);
+        const uint32_t sampleDelay = FilterDelay::getSampleDelay(sampleRate, value, useUnitMeter);
         if (sampleDelay > 0) {
-            filters.push_back(make_unique<FilterDelay>(_sampleRate, value, useUnitMeter));
+            filters.push_back(make_unique<FilterDelay>(sampleRate, value, useUnitMeter));
         }
         else {
             LOG_WARN("WARNING: Config(%s) - Discarding delay filter with to low value. Can't delay less then one sample", path.c_str());
@@ -82,7 +87,7 @@ void Config::parseDelay(vector<unique_ptr<Filter>>& filters, const shared_ptr<Js
     }
 }
 
-void Config::parseCompression(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const {
+void Config::parseCompression(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const {
     if (pNode->has("compression")) {
         const shared_ptr<JsonNode> pFilterNode = getObjectNode(pNode, "compression", path);
         const double threshold = getDoubleValue(pFilterNode, "threshold", path);
@@ -90,30 +95,38 @@ void Config::parseCompression(vector<unique_ptr<Filter>>& filters, const shared_
         const double attack = getDoubleValue(pFilterNode, "attack", path);
         const double release = getDoubleValue(pFilterNode, "release", path);
         const double window = tryGetDoubleValue(pFilterNode, "window", path);
-        filters.push_back(make_unique<FilterCompression>(_sampleRate, threshold, ratio, attack, release, window));
+        size_t controlInterval = COMPRESSION_CONTROL_INTERVAL;
+        if (pFilterNode->has("controlInterval")) {
+            const int value = getIntValue(pFilterNode, "controlInterval", path);
+            if (value < 1) {
+                throw Error("Config(%s) - Compression control interval must be at least one sample: %d", path.c_str(), value);
+            }
+            controlInterval = value;
+        }
+        filters.push_back(make_unique<FilterCompression>(sampleRate, threshold, ratio, attack, release, window, controlInterval));
     }
 }
 
-void Config::parseCancellation(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, string path) const {
+void Config::parseCancellation(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pNode, const uint32_t sampleRate, string path) const {
     if (pNode->has("cancellation")) {
         const shared_ptr<JsonNode> pFilterNode = getObjectNode(pNode, "cancellation", path);
         const double freq = getDoubleValue(pFilterNode, "freq", path);
         if (pFilterNode->has("gain")) {
             const double gain = getDoubleValue(pFilterNode, "gain", path);
-            filters.push_back(make_unique<FilterCancellation>(_sampleRate, freq, gain));
+            filters.push_back(make_unique<FilterCancellation>(sampleRate, freq, gain));
         }
         else {
-            filters.push_back(make_unique<FilterCancellation>(_sampleRate, freq));
+            filters.push_back(make_unique<FilterCancellation>(sampleRate, freq));
         }
     }
 }
 
-void Config::parseFilter(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+void Config::parseFilter(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path, const bool useFloat) const {
     const FilterType type = getFilterType(pFilterNode, "type", path);
     switch (type) {
     case FilterType::LOW_PASS:
     case FilterType::HIGH_PASS:
-        parseCrossover(type == FilterType::LOW_PASS, pFilterBiquad, pFilterNode, path);
+        parseCrossover(type == FilterType::LOW_PASS, filters, pFilterBiquad, pFilterNode, path);
         break;
     case FilterType::LOW_SHELF:
     case FilterType::HIGH_SHELF:
@@ -135,14 +148,38 @@ void Config::parseFilter(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFil
         parseBiquad(pFilterBiquad, pFilterNode, path);
         break;
     case FilterType::FIR:
-        parseFir(filters, pFilterNode, path);
+        parseFir(filters, pFilterNode, sampleRate, path, useFloat);
         break;
     default:
         throw Error("Config(%s) - Unknown filter type '%s'", path.c_str(), FilterTypes::toString(type).c_str());
     };
 }
 
-void Config::parseCrossover(const bool isLowPass, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+void Config::parseCrossover(const bool isLowPass, vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+    if (!tryGetBoolValue(pFilterNode, "linearPhase", path)) {
+        addCrossover(isLowPass, pFilterBiquad, pFilterNode, path);
+        return;
+    }
+    // Linear phase crossovers run as a symmetric FIR with the magnitude response of the biquads.
+    // Designed for the sample rate of the filter list, like the biquads would be.
+    FilterBiquad filterBiquad(pFilterBiquad->getSampleRate());
+    addCrossover(isLowPass, &filterBiquad, pFilterNode, path);
+    const vector<double> taps = FirDesign::linearPhase(filterBiquad.getBiquads(), getLinearPhaseTaps(pFilterNode, path));
+    filters.push_back(make_unique<FilterFir>(taps, FIR_FFT_PARTITION_SIZE, false, taps.size() / 2));
+}
+
+const size_t Config::getLinearPhaseTaps(const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+    if (!pFilterNode->has("linearPhaseTaps")) {
+        return LINEAR_PHASE_TAPS;
+    }
+    const int value = getIntValue(pFilterNode, "linearPhaseTaps", path);
+    if (value < 3) {
+        throw Error("Config(%s) - Linear phase FIR must have at least 3 taps: %d", path.c_str(), value);
+    }
+    return value;
+}
+
+void Config::addCrossover(const bool isLowPass, FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
     const CrossoverType crossoverType = getCrossoverType(pFilterNode, path);
     const double freq = getDoubleValue(pFilterNode, "freq", path);
     const uint8_t order = (uint8_t)getIntValue(pFilterNode, "order", path);
@@ -231,24 +268,73 @@ void Config::parseBiquad(FilterBiquad* pFilterBiquad, const shared_ptr<JsonNode>
     }
 }
 
-void Config::parseFir(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+void Config::parseFir(vector<unique_ptr<Filter>>& filters, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path, const bool useFloat) const {
     string myPath = path;
     // Read each line in fir parameter file
     const string filePath = getTextValue(pFilterNode, "file", myPath);
     const File file(filePath);
     const string extension = file.getExtension();
+    vector<double> taps;
     if (extension.compare("txt") == 0) {
-        parseFirTxt(filters, file, myPath);
+        taps = parseFirTxt(file, myPath);
     }
     else if (extension.compare("wav") == 0) {
-        parseFirWav(filters, file, myPath);
+        taps = parseFirWav(file, sampleRate, myPath);
     }
     else {
         throw Error("Config(%s) - Unknown file extension for FIR file '%s'", myPath.c_str(), file.getPath().c_str());
     }
+    // Same magnitude response with the energy moved to the start. Removes the delay of linear phase FIRs.
+    if (tryGetBoolValue(pFilterNode, "minimumPhase", myPath)) {
+        taps = FirDesign::minimumPhase(taps);
+    }
+    trimFir(filters, taps, pFilterNode, sampleRate, myPath);
+    if (tryGetBoolValue(pFilterNode, "zeroLatency", myPath)) {
+        filters.push_back(make_unique<FilterFirZeroLatency>(taps, getFirPartitionSize(pFilterNode, FIR_ZERO_LATENCY_HEAD_SIZE, myPath)));
+    }
+    // FFT convolution adds latency. Only used when the config asks for it.
+    else if (tryGetBoolValue(pFilterNode, "fft", myPath)) {
+        filters.push_back(make_unique<FilterFir>(taps, getFirPartitionSize(pFilterNode, FIR_FFT_PARTITION_SIZE, myPath)));
+    }
+    else {
+        filters.push_back(make_unique<FilterFir>(taps, 0, useFloat));
+    }
 }
 
-void Config::parseFirTxt(vector<unique_ptr<Filter>>& filters, const File& file, const string& path) const {
+void Config::trimFir(vector<unique_ptr<Filter>>& filters, vector<double>& taps, const shared_ptr<JsonNode>& pFilterNode, const uint32_t sampleRate, const string& path) const {
+    if (pFilterNode->has("trim") && !getBoolValue(pFilterNode, "trim", path)) {
+        return;
+    }
+    const double threshold = pFilterNode->has("trimThreshold") ? getDoubleValue(pFilterNode, "trimThreshold", path) : FIR_TRIM_THRESHOLD_DB;
+    if (threshold >= 0) {
+        throw Error("Config(%s) - FIR trim threshold must be below 0dB: %.1f", path.c_str(), threshold);
+    }
+    const pair<size_t, size_t> range = FirDesign::getTrimRange(taps, threshold);
+    const size_t start = range.first, end = range.second;
+    // Nothing to trim or no energy at all.
+    if (start >= end || (start == 0 && end == taps.size())) {
+        return;
+    }
+    LOG_INFO("Config(%s) - FIR trimmed from %zd to %zd taps. %zd leading taps replaced with delay", path.c_str(), taps.size(), end - start, start);
+    taps = vector<double>(taps.begin() + start, taps.begin() + end);
+    // Removed leading taps become an integer delay.
+    if (start) {
+        filters.push_back(make_unique<FilterDelay>(sampleRate, 1000.0 * start / sampleRate));
+    }
+}
+
+const size_t Config::getFirPartitionSize(const shared_ptr<JsonNode>& pFilterNode, const size_t defaultSize, const string& path) const {
+    if (pFilterNode->has("partitionSize")) {
+        const int partitionSize = getIntValue(pFilterNode, "partitionSize", path);
+        if (partitionSize < 16 || !FFT::isPowerOfTwo(partitionSize)) {
+            throw Error("Config(%s) - FIR partition size must be a power of two and at least 16: %d", path.c_str(), partitionSize);
+        }
+        return partitionSize;
+    }
+    return defaultSize;
+}
+
+const vector<double> Config::parseFirTxt(const File& file, const string& path) const {
     vector<string> lines;
     if (!file.getData(lines)) {
         throw Error("Config(%s) - Can't read FIR file '%s'", path.c_str(), file.getPath().c_str());
@@ -260,10 +346,10 @@ void Config::parseFirTxt(vector<unique_ptr<Filter>>& filters, const File& file,
     for (const string& str : lines) {
         taps.push_back(atof(str.c_str()));
     }
-    filters.push_back(make_unique<FilterFir>(taps));
+    return taps;
 }
 
-void Config::parseFirWav(vector<unique_ptr<Filter>>& filters, const File& file, const string& path) const {
+const vector<double> Config::parseFirWav(const File& file, const uint32_t sampleRate, const string& path) const {
     unique_ptr<char[]> pBuffer;
     // Get data
     const size_t bufferSize = file.getData(&pBuffer);
@@ -279,8 +365,8 @@ void Config::parseFirWav(vector<unique_ptr<Filter>>& filters, const File& file,
     if (header.numChannels != 1) {
         throw Error("Config(%s) - FIR file is not mono", path.c_str());
     }
-    if (header.sampleRate != _sampleRate) {
-        throw Error("Config(%s) - FIR file sample rate doesn't match render device. Render(%d), FIR(%d)", path.c_str(), _sampleRate, header.sampleRate);
+    if (header.sampleRate != sampleRate) {
+        throw Error("Config(%s) - FIR file sample rate doesn't match the filters. Filters(%d), FIR(%d)", path.c_str(), sampleRate, header.sampleRate);
     }
     // Generate taps
     const size_t numSamples = header.getNumSamples();
@@ -315,29 +401,33 @@ void Config::parseFirWav(vector<unique_ptr<Filter>>& filters, const File& file,
     else {
         throw Error("Config(%s) - FIR file is in unknown audio format: %u", path.c_str(), header.audioFormat);
     }
-    filters.push_back(make_unique<FilterFir>(taps));
+    return taps;
 }
 
-void Config::applyCrossoversMap(FilterBiquad* pFilterBiquad, const Channel channel, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
+void Config::applyCrossoversMap(vector<unique_ptr<Filter>>& filters, FilterBiquad* pFilterBiquad, const Channel channel, const shared_ptr<JsonNode>& pFilterNode, const string& path) const {
     // Check if this channel should have an LP and that there isn't an user defined LP in the filters list.
     if (_addLpTo.find(channel) != _addLpTo.end() && !hasCrossoverFilter(pFilterNode, true, path)) {
-        parseCrossover(true, pFilterBiquad, _pLpFilter, "basic");
+        parseCrossover(true, filters, pFilterBiquad, _pLpFilter, "basic");
     }
     if (_addHpTo.find(channel) != _addHpTo.end() && !hasCrossoverFilter(pFilterNode, false, path)) {
-        parseCrossover(false, pFilterBiquad, _pHpFilter, "basic");
+        parseCrossover(false, filters, pFilterBiquad, _pHpFilter, "basic");
     }
 }
 
 void Config::applyCrossoversMap(vector<unique_ptr<Filter>>& filters, const Channel channel) const {
     if (_addLpTo.find(channel) != _addLpTo.end()) {
         unique_ptr<FilterBiquad> pFilterBiquad = make_unique<FilterBiquad>(_sampleRate);
-        parseCrossover(true, pFilterBiquad.get(), _pLpFilter, "basic");
-        filters.push_back(move(pFilterBiquad));
+        parseCrossover(true, filters, pFilterBiquad.get(), _pLpFilter, "basic");
+        if (!pFilterBiquad->isEmpty()) {
+            filters.push_back(move(pFilterBiquad));
+        }
     }
     if (_addHpTo.find(channel) != _addHpTo.end()) {
         unique_ptr<FilterBiquad> pFilterBiquad = make_unique<FilterBiquad>(_sampleRate);
-        parseCrossover(false, pFilterBiquad.get(), _pHpFilter, "basic");
-        filters.push_back(move(pFilterBiquad));
+        parseCrossover(false, filters, pFilterBiquad.get(), _pHpFilter, "basic");
+        if (!pFilterBiquad->isEmpty()) {
+            filters.push_back(move(pFilterBiquad));
+        }
     }
 }
 
@@ -22,6 +22,10 @@ const vector<Route>& Input::getRoutes() const {
     return _routes;
 }
 
+vector<Route>& Input::getRoutes() {
+    return _routes;
+}
+
 void Input::addRoute(Route& route) {
     _routes.push_back(move(route));
 }
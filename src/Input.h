@@ -18,6 +18,7 @@ public:
     Input(const Channel channel, const Channel out);
 
     const vector<Route>& getRoutes() const;
+    vector<Route>& getRoutes();
     void addRoute(Route& route);
     const Channel getChannel() const;
     const bool isDefined() const;
@@ -25,12 +26,20 @@ public:
     void reset();
     const bool resetIsPlaying();
 
-    inline void route(const double data, double* const pRenderBuffer) {
-        if (data) {
-            _isPlaying = true;
+    inline void updateIsPlaying(const double* const pData, const size_t numSamples) {
+        if (!_isPlaying) {
+            for (size_t i = 0; i < numSamples; ++i) {
+                if (pData[i]) {
+                    _isPlaying = true;
+                    break;
+                }
+            }
         }
+    }
+
+    inline void route(const double* const pData, double* const* const pRenderBuffers, double* const pBuffer, const size_t numSamples) {
         for (const Route& route : _routes) {
-            route.process(data, pRenderBuffer);
+            route.process(pData, pRenderBuffers, pBuffer, numSamples);
         }
     }
 
@@ -20,6 +20,7 @@
 #include "TrayIcon.h"
 #include "Str.h"
 #include "AsioDevice.h"
+#include "Resampler.h"
 
 using std::exception;
 using std::make_shared;
@@ -148,16 +149,20 @@ void run() {
         throw Error("Bit depth doesnt match float(32), Found(%d)", pCaptureFormat->wBitsPerSample);
     }
 
-    uint32_t renderNumChannels;
+    uint32_t renderNumChannels, renderSampleRate;
 
     // ASIO render device.
     if (pConfig->useAsioRenderDevice()) {
         renderNumChannels = pConfig->getAsioNumChannels() > 0
             ? pConfig->getAsioNumChannels()
             : pCaptureDevice->getFormat()->nChannels;
+        const uint32_t asioSampleRate = pConfig->getAsioSampleRate() > 0
+            ? pConfig->getAsioSampleRate()
+            : pCaptureFormat->nSamplesPerSec;
         AsioDevice::initRenderService(
-            renderDeviceName, pCaptureFormat->nSamplesPerSec,
+            renderDeviceName, asioSampleRate,
             pConfig->getAsioBufferSize(), renderNumChannels, pConfig->inDebug());
+        renderSampleRate = AsioDevice::getSampleRate();
     }
     // WASAPI render device.
     else {
@@ -165,11 +170,8 @@ void run() {
         pRenderDevice->initRenderService();
         const WAVEFORMATEX* const pRenderFormat = pRenderDevice->getFormat();
         renderNumChannels = pRenderFormat->nChannels;
-        // The application have no resampler. Sample rate and bit depth must be a match.
-        if (pCaptureFormat->nSamplesPerSec != pRenderFormat->nSamplesPerSec) {
-            throw Error("Sample rate missmatch: Capture(%d), Render(%d)",
-                pCaptureFormat->nSamplesPerSec, pRenderFormat->nSamplesPerSec);
-        }
+        renderSampleRate = pRenderFormat->nSamplesPerSec;
+        // Bit depth and format must be a match. Sample rate is converted below.
         if (pCaptureFormat->wBitsPerSample != pRenderFormat->wBitsPerSample) {
             throw Error("Bit depth missmatch: Capture(%d), Render(%d)",
                 pCaptureFormat->wBitsPerSample, pRenderFormat->wBitsPerSample);
@@ -180,8 +182,14 @@ void run() {
         }
     }
 
-    // Read config and get I/O instances with filters 
-    pConfig->init(pCaptureFormat->nSamplesPerSec, pCaptureFormat->nChannels, renderNumChannels);
+    // Capture is resampled to the render sample rate when they differ.
+    if (pCaptureFormat->nSamplesPerSec != renderSampleRate && !Resampler::isSupported(pCaptureFormat->nSamplesPerSec, renderSampleRate)) {
+        throw Error("Sample rate missmatch: Capture(%d), Render(%d). Can't resample between these rates",
+            pCaptureFormat->nSamplesPerSec, renderSampleRate);
+    }
+
+    // Read config and get I/O instances with filters. Filters run at the render sample rate.
+    pConfig->init(renderSampleRate, pCaptureFormat->nChannels, renderNumChannels);
 
     /*
      * Print data to the user.
@@ -195,13 +203,16 @@ void run() {
         if (pConfig->inDebug()) {
             LOG_INFO("ASIO buffer: %d(%.1fms)",
                 AsioDevice::getBufferSize(),
-                1000.0 * AsioDevice::getBufferSize() / pCaptureFormat->nSamplesPerSec
+                1000.0 * AsioDevice::getBufferSize() / renderSampleRate
             );
         }
     }
     else {
         LOG_INFO("Render  : %s - WASAPI", renderDeviceName.c_str());
     }
+    if (pCaptureFormat->nSamplesPerSec != renderSampleRate) {
+        LOG_INFO("Resample: %dHz -> %dHz", pCaptureFormat->nSamplesPerSec, renderSampleRate);
+    }
     if (pConfig->inDebug()) {
         LOG_INFO("Log file: %s", LOG_FILE);
     }
@@ -4,12 +4,14 @@ Output::Output() {
     _channel = Channel::CHANNEL_NULL;
     _mute = false;
     _clipping = 0.0;
+    _bankFilterIndex = (size_t)-1;
 }
 
 Output::Output(const Channel channel, const bool mute) {
     _channel = channel;
     _mute = mute;
     _clipping = 0.0;
+    _bankFilterIndex = (size_t)-1;
 }
 
 void Output::addFilters(vector<unique_ptr<Filter>>& filters) {
@@ -30,6 +32,10 @@ const vector<unique_ptr<Filter>>& Output::getFilters() const {
     return _filters;
 }
 
+vector<unique_ptr<Filter>>& Output::getFilters() {
+    return _filters;
+}
+
 void Output::reset() const {
     for (const unique_ptr<Filter>& pFilter : _filters) {
         pFilter->reset();
@@ -52,4 +58,12 @@ const double Output::resetClipping() {
     const double result = _clipping;
     _clipping = 0.0;
     return result;
+}
+
+void Output::setBankFilterIndex(const size_t index) {
+    _bankFilterIndex = index;
+}
+
+const bool Output::hasBankFilter() const {
+    return _bankFilterIndex != (size_t)-1;
 }
\ No newline at end of file
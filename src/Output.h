@@ -10,6 +10,7 @@
 #define NOMINMAX
 #include <algorithm> // max
 #include <memory>
+#include <cstring> // memset
 #include "Filter.h"
 #include "Channel.h"
 
@@ -26,32 +27,66 @@ public:
     void addFilter(unique_ptr<Filter> pFilter);
     void addFilterFirst(unique_ptr<Filter> pFilter);
     const vector<unique_ptr<Filter>>& getFilters() const;
+    vector<unique_ptr<Filter>>& getFilters();
     const Channel Output::getChannel() const;
     const bool isDefined() const;
     const bool isMuted() const;
     void reset() const;
     const double resetClipping();
+    // Filter at index is processed externally by a biquad bank between processPreBank() and processPostBank().
+    void setBankFilterIndex(const size_t index);
+    const bool hasBankFilter() const;
 
-    inline const double process(double data) {
+    // Apply filters to a block of samples in place.
+    inline void process(double* const pData, const size_t numSamples) {
         if (_mute) {
-            return 0.0;
+            memset(pData, 0, numSamples * sizeof(double));
+            return;
         }
-        for (const unique_ptr<Filter>& pFilter : _filters) {
-            data = pFilter->process(data);
+        processFilters(pData, 0, _filters.size(), numSamples);
+        clip(pData, numSamples);
+    }
+
+    // Apply filters before the banked filter.
+    inline void processPreBank(double* const pData, const size_t numSamples) {
+        if (!_mute) {
+            processFilters(pData, 0, _bankFilterIndex, numSamples);
         }
-        if (abs(data) > 1.0) {
-            // Record clipping level so it can be shown in error message.
-            _clipping = max(_clipping, abs(data));
-            // Clamp/limit to max value to avoid damaging equipment.
-            return data > 0.0 ? 1.0 : -1.0;
+    }
+
+    // Apply filters after the banked filter.
+    inline void processPostBank(double* const pData, const size_t numSamples) {
+        if (_mute) {
+            memset(pData, 0, numSamples * sizeof(double));
+            return;
         }
-        return data;
+        processFilters(pData, _bankFilterIndex + 1, _filters.size(), numSamples);
+        clip(pData, numSamples);
     }
 
 private:
     vector<unique_ptr<Filter>> _filters;
     Channel _channel;
+    size_t _bankFilterIndex;
     double _clipping;
     bool _mute;
 
+    inline void processFilters(double* const pData, const size_t start, const size_t end, const size_t numSamples) const {
+        for (size_t i = start; i < end; ++i) {
+            _filters[i]->process(pData, pData, numSamples);
+        }
+    }
+
+    inline void clip(double* const pData, const size_t numSamples) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            const double data = pData[i];
+            if (abs(data) > 1.0) {
+                // Record clipping level so it can be shown in error message.
+                _clipping = max(_clipping, abs(data));
+                // Clamp/limit to max value to avoid damaging equipment.
+                pData[i] = data > 0.0 ? 1.0 : -1.0;
+            }
+        }
+    }
+
 };
\ No newline at end of file
@@ -1,15 +1,23 @@
 #include "Route.h"
+#include "FilterGain.h"
+#include "FilterCompression.h"
 
 Route::Route() {
     _channel = Channel::CHANNEL_NULL;
     _channelIndex = (size_t)-1;
     _valid = true;
+    _batched = false;
+    _firstFilter = 0;
+    _mixGain = 1.0;
 }
 
 Route::Route(const Channel channel) {
     _channel = channel;
     _channelIndex = (size_t)channel;
     _valid = true;
+    _batched = false;
+    _firstFilter = 0;
+    _mixGain = 1.0;
 }
 
 void Route::addFilters(vector<unique_ptr<Filter>>& filters) {
@@ -38,10 +46,47 @@ const bool Route::hasConditions() const {
     return _conditions.size() != 0;
 }
 
+const bool Route::isValid() const {
+    return _valid;
+}
+
+const bool Route::isBatched() const {
+    return _batched;
+}
+
+void Route::setBatched(const bool batched) {
+    _batched = batched;
+}
+
+void Route::foldGainPrefix() {
+    // Compression depends on the level so a gain can't be moved past it.
+    for (const unique_ptr<Filter>& pFilter : _filters) {
+        if (typeid (*pFilter) == typeid (FilterCompression)) {
+            return;
+        }
+    }
+    while (_firstFilter < _filters.size() && typeid (*_filters[_firstFilter]) == typeid (FilterGain)) {
+        _mixGain *= ((FilterGain*)_filters[_firstFilter].get())->getMultiplier();
+        ++_firstFilter;
+    }
+}
+
+const double Route::getMixGain() const {
+    return _mixGain;
+}
+
+const bool Route::isGainOnly() const {
+    return _firstFilter == _filters.size();
+}
+
 const vector<unique_ptr<Filter>>& Route::getFilters() const {
     return _filters;
 }
 
+vector<unique_ptr<Filter>>& Route::getFilters() {
+    return _filters;
+}
+
 void Route::evalConditions() {
     bool valid = true;
     for (const Condition& cond : _conditions) {
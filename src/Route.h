@@ -28,16 +28,43 @@ public:
     const Channel getChannel() const;
     const size_t getChannelIndex() const;
     const bool hasConditions() const;
+    const bool isValid() const;
+    // Batched routes are processed by a shared stage in the capture loop, ConvolutionMatrix or MixingMatrix, instead of in process().
+    const bool isBatched() const;
+    void setBatched(const bool batched);
+    // Moves leading gain filters into the mix gain. Only done when the rest of the chain is linear.
+    void foldGainPrefix();
+    // Linear gain applied when mixing into the output.
+    const double getMixGain() const;
+    // True if all filters are folded into the mix gain.
+    const bool isGainOnly() const;
     const vector<unique_ptr<Filter>>& getFilters() const;
+    vector<unique_ptr<Filter>>& getFilters();
     void evalConditions();
     void reset() const;
 
-    inline void process(double data, double* const pRenderBuffer) const {
-        if (_valid) {
-            for (const unique_ptr<Filter>& pFilter : _filters) {
-                data = pFilter->process(data);
+    // Process a block of input samples and mix the result into the block buffer of the output channel.
+    // pBuffer is a scratch buffer of at least numSamples size used for filtering.
+    inline void process(const double* const pData, double* const* const pRenderBuffers, double* const pBuffer, const size_t numSamples) const {
+        if (_valid && !_batched) {
+            double* const pRenderBuffer = pRenderBuffers[_channelIndex];
+            const double mixGain = _mixGain;
+            // No filters. Just mix input into output.
+            if (_firstFilter == _filters.size()) {
+                for (size_t i = 0; i < numSamples; ++i) {
+                    pRenderBuffer[i] += mixGain * pData[i];
+                }
+                return;
+            }
+            // First filter reads from the input block. The rest works in place on the scratch buffer.
+            const double* pIn = pData;
+            for (size_t i = _firstFilter; i < _filters.size(); ++i) {
+                _filters[i]->process(pIn, pBuffer, numSamples);
+                pIn = pBuffer;
+            }
+            for (size_t i = 0; i < numSamples; ++i) {
+                pRenderBuffer[i] += mixGain * pBuffer[i];
             }
-            pRenderBuffer[_channelIndex] += data;
         }
     }
 
@@ -45,7 +72,9 @@ private:
     vector<unique_ptr<Filter>> _filters;
     vector<Condition> _conditions;
     Channel _channel;
-    size_t _channelIndex;
-    bool _valid;
+    // Filters before _firstFilter are folded into _mixGain.
+    size_t _channelIndex, _firstFilter;
+    double _mixGain;
+    bool _valid, _batched;
 
 };
\ No newline at end of file